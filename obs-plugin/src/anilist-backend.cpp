@@ -0,0 +1,86 @@
+#include "anilist-backend.hpp"
+#include "http-client.hpp"
+#include <nlohmann/json.hpp>
+#include <obs-module.h>
+
+static const char *ANILIST_URL = "https://graphql.anilist.co";
+
+// Custom lists repeat entries of the status lists, so they are skipped
+static const char *ANILIST_QUERY =
+    "query ($name: String, $type: MediaType, $status: MediaListStatus) {"
+    " MediaListCollection(userName: $name, type: $type, status: $status, forceSingleCompletedList: true) {"
+    " lists { isCustomList entries { status progress"
+    " media { id title { userPreferred romaji } coverImage { large } } } } } }";
+
+// MAL status name -> AniList MediaListStatus
+static const char *anilist_status(const std::string &status)
+{
+    if (status == "READING" || status == "WATCHING") return "CURRENT";
+    if (status == "COMPLETED") return "COMPLETED";
+    if (status == "PAUSED") return "PAUSED";
+    if (status == "DROPPED") return "DROPPED";
+    if (status == "PLANNING") return "PLANNING";
+    return nullptr;
+}
+
+// AniList MediaListStatus -> MAL status name for the media
+static std::string mal_status(const std::string &status, const std::string &media)
+{
+    if (status == "CURRENT" || status == "REPEATING") return media == "manga" ? "READING" : "WATCHING";
+    return status;
+}
+
+std::vector<MALEntry> AniListBackend::fetchMedia(const std::string &username, const std::string &media,
+                                                 const std::string &status, const std::atomic<bool> *cancel)
+{
+    nlohmann::json variables = {{"name", username}, {"type", media == "manga" ? "MANGA" : "ANIME"}};
+    if (const char *s = anilist_status(status)) variables["status"] = s;
+
+    http_request req;
+    req.url = endpoint_.empty() ? ANILIST_URL : endpoint_;
+    req.body = nlohmann::json{{"query", ANILIST_QUERY}, {"variables", variables}}.dump();
+    req.headers = {"Content-Type: application/json", "Accept: application/json"};
+    req.cancel = cancel;
+
+    blog(LOG_INFO, "Fetching AniList %s list for %s (%s)", media.c_str(), username.c_str(), status.c_str());
+    std::string body = http_fetch(req);
+
+    std::vector<MALEntry> entries;
+    try {
+        auto json = nlohmann::json::parse(body);
+        const auto &lists = json.at("data").at("MediaListCollection").at("lists");
+        for (const auto &list : lists) {
+            if (list.value("isCustomList", false)) continue;
+            for (const auto &item : list.at("entries")) {
+                const auto &m = item.at("media");
+                const auto &title = m.at("title");
+                // Title variants a media lacks come back as null
+                auto title_of = [&](const char *variant) {
+                    auto it = title.find(variant);
+                    return it != title.end() && it->is_string() ? it->get<std::string>() : std::string();
+                };
+
+                MALEntry entry;
+                entry.id = std::to_string(m.at("id").get<int>());
+                entry.title = title_of("userPreferred");
+                if (entry.title.empty()) entry.title = title_of("romaji");
+                // So may the cover, or the whole coverImage of a media without one
+                auto cover = m.find("coverImage");
+                if (cover != m.end() && cover->is_object()) {
+                    auto large = cover->find("large");
+                    if (large != cover->end() && large->is_string()) entry.coverImage = large->get<std::string>();
+                }
+                entry.status = mal_status(item.value("status", ""), media);
+                entry.progress = item.value("progress", 0);
+                entry.media = media;
+                entries.push_back(entry);
+            }
+        }
+    } catch (const std::exception &e) {
+        // A 2xx with an unexpected body (e.g. GraphQL errors) is a failed fetch
+        throw std::runtime_error(std::string("unexpected AniList response: ") + e.what());
+    }
+
+    blog(LOG_INFO, "Fetched %zu entries", entries.size());
+    return entries;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "list-backend.hpp"
+
+// AniList's GraphQL API: one MediaListCollection query returns a media's
+// lists for every status, grouped, with only the fields asked for.
+class AniListBackend : public ListBackend {
+public:
+    // `endpoint` (optional) replaces https://graphql.anilist.co
+    explicit AniListBackend(const std::string &endpoint = "") : endpoint_(endpoint) {}
+
+protected:
+    bool groupsStatuses() const override { return true; }
+
+    std::vector<MALEntry> fetchMedia(const std::string &username, const std::string &media,
+                                     const std::string &status, const std::atomic<bool> *cancel) override;
+
+private:
+    std::string endpoint_;
+};
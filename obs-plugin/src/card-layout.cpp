@@ -0,0 +1,173 @@
+#include "card-layout.hpp"
+#include <graphics/graphics.h>
+#include <algorithm>
+#include <cmath>
+
+card_span card_visible_span(const card_layout_params &params, size_t n,
+                            float scroll_offset, float view_width)
+{
+    card_span span = {0, 0, 0.0f};
+    if (n == 0 || params.pitch <= 0.0f) return span;
+
+    float first = std::floor(scroll_offset / params.pitch);
+    if (first < 0.0f) first = 0.0f;
+    span.first = (size_t)first % n;
+    span.x0 = (float)span.first * params.pitch - scroll_offset;
+
+    // Slots until the right edge of the view, but never past the second copy of the strip
+    float slots = std::ceil((view_width - span.x0) / params.pitch);
+    size_t max_slots = 2 * n - span.first;
+    span.count = slots > 0.0f ? std::min((size_t)slots, max_slots) : 0;
+    return span;
+}
+
+// One instantiation per flag combination, so the body has no runtime
+// checks for them and there is a single copy of the layout rules.
+template <bool TextBackground, bool HasCover>
+static void build_card_ops(const card_layout_params &params, const card_textures &textures,
+                           std::vector<card_op> &ops)
+{
+    ops.clear();
+
+    const float pad = TextBackground ? params.background_padding : 0.0f;
+    float avail = params.item_width - 12.0f - pad * 2.0f;
+    if (avail < 1.0f) avail = 1.0f;
+
+    auto push_text = [&](gs_texture_t *tex, uint32_t tw, uint32_t th, float x, float y, float scale) {
+        if (!tex || tw == 0 || th == 0 || scale <= 0.0f) return;
+        float w = tw * scale;
+        float h = th * scale;
+        if (TextBackground) {
+            ops.push_back(card_op{draw_layer::background, x - pad, y - pad,
+                                  w + pad * 2.0f, h + pad * 2.0f, nullptr, 1, 1});
+        }
+        ops.push_back(card_op{draw_layer::text, x, y, w, h, tex, tw, th});
+    };
+
+    float scaled_height = 0.0f;
+    if (HasCover) {
+        uint32_t img_width = gs_texture_get_width(textures.cover);
+        uint32_t img_height = gs_texture_get_height(textures.cover);
+        float scale = params.item_width / img_width;
+        scaled_height = img_height * scale;
+        ops.push_back(card_op{draw_layer::cover, 0.0f, 0.0f, params.item_width, scaled_height,
+                              textures.cover, img_width, img_height});
+    }
+
+    // Status badge near the top-left of the cover, at least 1.5x for visibility
+    if (textures.status && textures.status_w > 0) {
+        float badge_scale = std::max(1.5f, std::min(3.0f, std::min(params.text_scale, avail / (float)textures.status_w)));
+        push_text(textures.status, textures.status_w, textures.status_h, 6.0f, 6.0f, badge_scale);
+    }
+
+    // Title under the cover (only once the cover is known, since it sets the baseline)
+    if (HasCover && textures.title[0]) {
+        const float line_spacing = 4.0f;
+        float y = scaled_height + 8.0f;
+        for (int i = 0; i < 4; i++) {
+            uint32_t tw = textures.title_w[i];
+            uint32_t th = textures.title_h[i];
+            if (!textures.title[i] || tw == 0 || th == 0) continue;
+            float scale = std::min(3.0f, std::min(params.text_scale, avail / (float)tw));
+            push_text(textures.title[i], tw, th, 6.0f, y, scale);
+            y += th * scale + line_spacing;
+        }
+    }
+}
+
+void card_layout_specialize(card_layout_params &params)
+{
+    if (params.text_background) {
+        params.build_with_cover = build_card_ops<true, true>;
+        params.build_without_cover = build_card_ops<true, false>;
+    } else {
+        params.build_with_cover = build_card_ops<false, true>;
+        params.build_without_cover = build_card_ops<false, false>;
+    }
+}
+
+void card_layout_build(const card_layout_params &params, const card_textures &textures,
+                       std::vector<card_op> &ops)
+{
+    bool has_cover = textures.cover && gs_texture_get_width(textures.cover) > 0 &&
+                     gs_texture_get_height(textures.cover) > 0;
+    card_build_fn build = has_cover ? params.build_with_cover : params.build_without_cover;
+    if (!build) {
+        ops.clear();
+        return;
+    }
+    build(params, textures, ops);
+}
+
+void card_queue(const std::vector<card_op> &ops, float x, draw_batch &batch)
+{
+    const uint32_t card = batch.cards++;
+    for (const auto &op : ops) {
+        batch.cmds.push_back(draw_cmd{op.kind, op.tex, x + op.x, op.y, op.w, op.h, 0, op.tex_w, op.tex_h, card});
+    }
+}
+
+bool card_target_begin(gs_texrender_t *render, float x, float y, uint32_t w, uint32_t h)
+{
+    gs_texrender_reset(render);
+    if (!gs_texrender_begin(render, w, h)) return false;
+
+    struct vec4 clear_color;
+    vec4_zero(&clear_color);
+    gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+    gs_ortho(x, x + w, y, y + h, -100.0f, 100.0f);
+
+    // Accumulate premultiplied color with straight alpha so the result can be
+    // blended back with ONE / INVSRCALPHA
+    gs_blend_state_push();
+    gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    return true;
+}
+
+void card_target_end(gs_texrender_t *render)
+{
+    gs_blend_state_pop();
+    gs_texrender_end(render);
+}
+
+bool card_compose(const card_layout_params &params, const std::vector<card_op> &ops,
+                  gs_texture_t *white, card_image &image)
+{
+    if (!image.render || ops.empty()) return false;
+
+    float min_x = 0.0f, min_y = 0.0f, max_x = 0.0f, max_y = 0.0f;
+    for (const auto &op : ops) {
+        min_x = std::min(min_x, op.x);
+        min_y = std::min(min_y, op.y);
+        max_x = std::max(max_x, op.x + op.w);
+        max_y = std::max(max_y, op.y + op.h);
+    }
+    image.x = std::floor(min_x);
+    image.y = std::floor(min_y);
+    image.w = (uint32_t)std::ceil(max_x - image.x);
+    image.h = (uint32_t)std::ceil(max_y - image.y);
+    if (image.w == 0 || image.h == 0) return false;
+
+    if (!card_target_begin(image.render, image.x, image.y, image.w, image.h)) return false;
+    draw_batch batch;
+    card_queue(ops, 0.0f, batch);
+    draw_batch_flush(batch, params.background_color, white);
+    card_target_end(image.render);
+    return true;
+}
+
+void card_queue_image(const card_image &image, float x, draw_batch &batch)
+{
+    gs_texture_t *tex = gs_texrender_get_texture(image.render);
+    if (!tex) return;
+    batch.cmds.push_back(draw_cmd{draw_layer::premultiplied, tex, x + image.x, image.y,
+                                  (float)image.w, (float)image.h, 0, image.w, image.h, batch.cards++});
+}
+
+void card_queue_region(gs_texture_t *tex, float x, uint32_t sub_x, uint32_t sub_w, uint32_t h,
+                       draw_batch &batch)
+{
+    if (!tex || sub_w == 0 || h == 0) return;
+    batch.cmds.push_back(draw_cmd{draw_layer::premultiplied, tex, x, 0.0f,
+                                  (float)sub_w, (float)h, sub_x, sub_w, h, batch.cards++});
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/vec4.h>
+#include "render-state.hpp"
+#include <vector>
+
+struct card_layout_params;
+struct card_textures;
+struct card_op;
+
+using card_build_fn = void (*)(const card_layout_params &params, const card_textures &textures,
+                               std::vector<card_op> &ops);
+
+// Settings-derived geometry shared by every card. Recomputed only when the
+// source settings change, never per frame.
+struct card_layout_params {
+    float item_width;
+    float pitch; // item_width + item_gap
+    float text_scale;
+    bool text_background;
+    float background_padding;
+    struct vec4 background_color;
+
+    // Builder instantiations for the current flags (see card_layout_specialize)
+    card_build_fn build_with_cover;
+    card_build_fn build_without_cover;
+};
+
+// Picks the builder instantiations specialized on the layout flags. Call
+// whenever text_background changes, so building a card never branches on it.
+void card_layout_specialize(card_layout_params &params);
+
+// Textures a card is built from; any of them may still be missing.
+struct card_textures {
+    gs_texture_t *cover;
+    gs_texture_t *title[4];
+    uint32_t title_w[4];
+    uint32_t title_h[4];
+    gs_texture_t *status;
+    uint32_t status_w;
+    uint32_t status_h;
+};
+
+// One draw in a card's display list, positioned relative to the card's
+// top-left corner. Backgrounds use the shared white texture and the
+// background color from card_layout_params.
+struct card_op {
+    draw_layer kind;
+    float x;
+    float y;
+    float w; // on-screen size
+    float h;
+    gs_texture_t *tex;
+    uint32_t tex_w;
+    uint32_t tex_h;
+};
+
+// Card slots that intersect the view, in scroll order. Slot k shows entry
+// (first + k) % n at x = x0 + k * pitch.
+struct card_span {
+    size_t first;
+    size_t count;
+    float x0;
+};
+
+// Computes the visible slots directly from the scroll offset (cards share one
+// pitch), so the cost is proportional to what is on screen, not to n. The
+// strip wraps at most once, matching the two-pass layout it replaces.
+card_span card_visible_span(const card_layout_params &params, size_t n,
+                            float scroll_offset, float view_width);
+
+// Builds the immutable display list for one card, dispatching once to the
+// instantiation for the card's cover state.
+void card_layout_build(const card_layout_params &params, const card_textures &textures,
+                       std::vector<card_op> &ops);
+
+// Queues a display list for playback at horizontal offset x.
+void card_queue(const std::vector<card_op> &ops, float x, draw_batch &batch);
+
+// A card composited once into an offscreen texture. x/y is the offset of
+// the texture's top-left corner from the card origin (backgrounds may
+// extend past the cover edge by the padding).
+struct card_image {
+    gs_texrender_t *render;
+    float x;
+    float y;
+    uint32_t w;
+    uint32_t h;
+};
+
+// Starts rendering into `render` with the target's top-left corner at (x, y)
+// in card/strip coordinates. Draws in between are composited with
+// premultiplied alpha. Returns false if the target could not be bound.
+bool card_target_begin(gs_texrender_t *render, float x, float y, uint32_t w, uint32_t h);
+void card_target_end(gs_texrender_t *render);
+
+// Renders the display list into image.render (which must already exist).
+// Returns false if there was nothing to draw or the render target failed.
+bool card_compose(const card_layout_params &params, const std::vector<card_op> &ops,
+                  gs_texture_t *white, card_image &image);
+
+// Queues a composed card as a single premultiplied-alpha sprite at x.
+void card_queue_image(const card_image &image, float x, draw_batch &batch);
+
+// Queues columns [sub_x, sub_x + sub_w) of a premultiplied-alpha texture with
+// its left edge at screen position x (a UV-offset blit).
+void card_queue_region(gs_texture_t *tex, float x, uint32_t sub_x, uint32_t sub_w, uint32_t h,
+                       draw_batch &batch);
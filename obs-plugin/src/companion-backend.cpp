@@ -0,0 +1,247 @@
+#include "companion-backend.hpp"
+#include "http-client.hpp"
+#include "list-store.hpp"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include <obs-module.h>
+#include <util/platform.h>
+
+// The server sends a keep-alive comment every 20 s; a stream silent for
+// longer than this is considered dead and reopened
+static const long STREAM_IDLE_TIMEOUT_S = 60;
+static const int RECONNECT_DELAY_MS = 2000;
+
+// Entries as the server sends them; ids may be numbers or strings
+static MALEntry parse_item(const nlohmann::json &item)
+{
+    MALEntry entry;
+    const auto &id = item.at("id");
+    entry.id = id.is_string() ? id.get<std::string>() : std::to_string(id.get<long long>());
+    entry.title = item.value("title", "");
+    entry.coverImage = item.value("coverImage", "");
+    entry.status = item.value("status", "");
+    entry.progress = item.value("progress", 0);
+    entry.media = item.value("media", "manga");
+    return entry;
+}
+
+static std::vector<MALEntry> parse_items(const nlohmann::json &items)
+{
+    std::vector<MALEntry> entries;
+    for (const auto &item : items) {
+        entries.push_back(parse_item(item));
+    }
+    return entries;
+}
+
+// The server's key for an entry in diffs, e.g. "manga-2"
+static std::string item_key(const MALEntry &entry)
+{
+    return entry.media + "-" + entry.id;
+}
+
+std::vector<MALEntry> CompanionBackend::fetchMedia(const std::string &, const std::string &media,
+                                                   const std::string &status, const std::atomic<bool> *cancel)
+{
+    http_request req;
+    req.url = endpoint_ + "/api/list?media=" + media + "&status=" + status;
+    req.headers = {"Accept: application/json"};
+    req.cancel = cancel;
+
+    blog(LOG_INFO, "Fetching %s list (%s) from companion server %s", media.c_str(), status.c_str(),
+         endpoint_.c_str());
+    std::string body = http_fetch(req);
+
+    std::vector<MALEntry> entries;
+    try {
+        entries = parse_items(nlohmann::json::parse(body).at("items"));
+    } catch (const std::exception &e) {
+        throw std::runtime_error(std::string("unexpected companion server response: ") + e.what());
+    }
+
+    blog(LOG_INFO, "Fetched %zu entries", entries.size());
+    return entries;
+}
+
+struct companion_watch {
+    list_key key;
+    int subscribers = 0;             // guarded by g_watch_mutex
+    std::atomic<bool> stop{false};   // last subscriber left, or unload
+    std::atomic<bool> connected{false};
+};
+
+static std::mutex g_watch_mutex;
+static std::map<list_key, companion_handle> g_watches;
+static std::atomic<int> g_watch_threads(0);
+
+// Applies one SSE event to the list kept for the stream. Returns true if
+// the list changed.
+static bool apply_event(const std::string &event, const std::string &data, std::vector<MALEntry> &entries,
+                        bool &have_list)
+{
+    auto json = nlohmann::json::parse(data);
+    if (event == "snapshot") {
+        entries = parse_items(json.at("items"));
+        have_list = true;
+        return true;
+    }
+    if (event != "diff" || !have_list) return false;
+
+    std::vector<std::string> removed = json.value("removed", std::vector<std::string>());
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&](const MALEntry &e) {
+                                     return std::find(removed.begin(), removed.end(), item_key(e)) !=
+                                            removed.end();
+                                 }),
+                  entries.end());
+    if (json.contains("updated")) {
+        for (const auto &item : json["updated"]) {
+            MALEntry updated = parse_item(item);
+            for (auto &e : entries) {
+                if (item_key(e) == item_key(updated)) e = updated;
+            }
+        }
+    }
+    if (json.contains("added")) {
+        for (const auto &item : json["added"]) {
+            entries.push_back(parse_item(item));
+        }
+    }
+    return true;
+}
+
+// Reads one connection's events until it ends. Blocks are separated by a
+// blank line; "event:" names the block, "data:" lines carry its JSON and
+// lines starting with ':' are keep-alive comments.
+static void read_stream(companion_watch *w, const std::string &url)
+{
+    std::string buffer;
+    std::vector<MALEntry> entries;
+    bool have_list = false;
+
+    auto handle_block = [&](const std::string &block) {
+        std::string event = "message", data;
+        size_t start = 0;
+        while (start < block.size()) {
+            size_t end = block.find('\n', start);
+            if (end == std::string::npos) end = block.size();
+            std::string line = block.substr(start, end - start);
+            start = end + 1;
+
+            size_t colon = line.find(':');
+            if (colon == 0 || colon == std::string::npos) continue;
+            std::string field = line.substr(0, colon);
+            std::string value = line.substr(colon + 1);
+            if (!value.empty() && value[0] == ' ') value.erase(0, 1);
+            if (field == "event") event = value;
+            else if (field == "data") data += (data.empty() ? "" : "\n") + value;
+        }
+        if (data.empty()) return;
+
+        try {
+            if (!apply_event(event, data, entries, have_list)) return;
+        } catch (const std::exception &e) {
+            blog(LOG_WARNING, "[MAL] Ignoring malformed '%s' event from companion server: %s", event.c_str(),
+                 e.what());
+            return;
+        }
+        std::vector<MALEntry> sorted = entries;
+        list_sort_for_display(w->key, sorted);
+        list_store_publish(w->key, std::make_shared<const std::vector<MALEntry>>(std::move(sorted)));
+        w->connected = true;
+        blog(LOG_INFO, "[MAL] Companion server pushed %s: %zu entries", event.c_str(), entries.size());
+    };
+
+    http_request req;
+    req.url = url;
+    req.headers = {"Accept: text/event-stream"};
+    req.cancel = &w->stop;
+    http_stream(req, STREAM_IDLE_TIMEOUT_S, [&](const char *data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            if (data[i] != '\r') buffer += data[i];
+        }
+        size_t end;
+        while ((end = buffer.find("\n\n")) != std::string::npos) {
+            handle_block(buffer.substr(0, end));
+            buffer.erase(0, end + 2);
+        }
+        return !w->stop;
+    });
+}
+
+static void watch_thread_main(companion_handle w)
+{
+    const std::string url =
+        w->key.endpoint + "/api/stream?media=" + w->key.media + "&status=" + w->key.status;
+    blog(LOG_INFO, "[MAL] Subscribing to companion server: %s", url.c_str());
+
+    while (!w->stop) {
+        try {
+            read_stream(w.get(), url);
+        } catch (const std::exception &e) {
+            if (!w->stop) blog(LOG_WARNING, "[MAL] Companion stream %s: %s", url.c_str(), e.what());
+        }
+        w->connected = false;
+
+        // Failures also back the host off in the rate limiter, so a server
+        // that is down is retried less and less often
+        for (int i = 0; i < RECONNECT_DELAY_MS / 100 && !w->stop; i++) {
+            os_sleep_ms(100);
+        }
+    }
+    g_watch_threads--;
+}
+
+companion_handle companion_subscribe(const list_key &key)
+{
+    std::lock_guard<std::mutex> lock(g_watch_mutex);
+    companion_handle &w = g_watches[key];
+    if (!w) {
+        w = std::make_shared<companion_watch>();
+        w->key = key;
+        g_watch_threads++;
+        std::thread(watch_thread_main, w).detach();
+    }
+    w->subscribers++;
+    return w;
+}
+
+void companion_unsubscribe(companion_handle &handle)
+{
+    if (!handle) return;
+    std::lock_guard<std::mutex> lock(g_watch_mutex);
+    if (--handle->subscribers == 0) {
+        handle->stop = true;
+        auto it = g_watches.find(handle->key);
+        if (it != g_watches.end() && it->second == handle) g_watches.erase(it);
+    }
+    handle.reset();
+}
+
+bool companion_connected(const companion_handle &handle)
+{
+    return handle && handle->connected;
+}
+
+void companion_stop_all()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_watch_mutex);
+        for (auto &it : g_watches) {
+            it.second->stop = true;
+        }
+        g_watches.clear();
+    }
+
+    // curl notices the stop flag within a second
+    for (int i = 0; i < 200 && g_watch_threads > 0; i++) {
+        os_sleep_ms(10);
+    }
+    if (g_watch_threads > 0) {
+        blog(LOG_WARNING, "[MAL] %d companion streams still open at unload", (int)g_watch_threads);
+    }
+}
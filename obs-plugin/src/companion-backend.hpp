@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include "list-backend.hpp"
+
+// The companion server (server.js at the repository root), which already
+// scrapes the list for the browser-source overlay. Sharing it means one
+// scraper feeds both outputs. The server scrapes its own configured user,
+// so key.username is not used.
+class CompanionBackend : public ListBackend {
+public:
+    explicit CompanionBackend(const std::string &endpoint) : endpoint_(endpoint) {}
+
+protected:
+    bool groupsStatuses() const override { return true; }
+
+    std::vector<MALEntry> fetchMedia(const std::string &username, const std::string &media,
+                                     const std::string &status, const std::atomic<bool> *cancel) override;
+
+private:
+    std::string endpoint_;
+};
+
+// Besides answering fetches, the server pushes changes over a kept-alive
+// Server-Sent Events stream (/api/stream): the whole list once connected,
+// then a diff whenever its own polling sees the list change. Each diff is
+// applied to the last list and stored with list_store_publish, so updates
+// land without waiting for a source's refresh interval.
+//
+// One stream per key, shared by every source subscribed to it. The stream
+// reconnects on its own (paced by the host's rate limiter) until the last
+// subscriber lets go.
+
+struct companion_watch;
+typedef std::shared_ptr<companion_watch> companion_handle;
+
+companion_handle companion_subscribe(const list_key &key);
+
+// Drops the subscription and resets `handle`; the stream closes with the last one.
+void companion_unsubscribe(companion_handle &handle);
+
+// True while the subscription's stream is connected and has delivered a list;
+// sources need not poll meanwhile.
+bool companion_connected(const companion_handle &handle);
+
+// Closes every stream; called at module unload.
+void companion_stop_all();
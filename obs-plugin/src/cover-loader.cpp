@@ -0,0 +1,381 @@
+#include "cover-loader.hpp"
+#include "http-client.hpp"
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <obs-module.h>
+#include <util/platform.h>
+
+// Downloads mostly wait on the network; two workers keep a scroll through a
+// cold list fed without competing with OBS for cores
+static const int WORKER_COUNT = 2;
+
+static const char *MAL_CDN = "https://cdn.myanimelist.net/";
+static const int MAL_BASE_WIDTH = 225;
+static const int MAL_LARGE_WIDTH = 425;
+
+// Disk cache bounds: past the cap, the least recently used covers are
+// deleted until the cache is back under the target. A cover is 10-60 KB,
+// so the cap still holds several thousand.
+static const uint64_t CACHE_MAX_BYTES = 256ULL * 1024 * 1024;
+static const uint64_t CACHE_TRIM_BYTES = 192ULL * 1024 * 1024;
+
+static std::mutex g_mutex;
+static std::condition_variable g_wake;
+static std::deque<cover_handle> g_queue;
+static std::vector<std::thread> g_workers;
+static std::atomic<bool> g_stop(false);
+
+// WebP variants the CDN answered 404 for; not asked for again this session
+static std::set<std::string> g_no_webp;
+
+static std::mutex g_stats_mutex;
+static cover_loader_stats g_stats = {};
+
+static std::mutex g_cache_mutex;
+static uint64_t g_cache_bytes = 0; // size of the covers directory, as last counted
+static bool g_cache_scanned = false;
+
+cover_job::~cover_job()
+{
+    // Decoded but never taken; there is no texture to destroy yet
+    if (image.loaded) gs_image_file_free(&image);
+}
+
+static std::string config_path(const std::string &file)
+{
+    char *path = obs_module_config_path(file.c_str());
+    if (!path) return std::string();
+    std::string result = path;
+    bfree(path);
+    return result;
+}
+
+// Cache file for a URL: its path on the host, flattened, so a URL can never
+// escape the covers directory
+static std::string cache_file(const std::string &url)
+{
+    size_t scheme = url.find("://");
+    size_t start = url.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+    std::string name = start == std::string::npos ? url : url.substr(start + 1);
+    for (char &c : name) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' ||
+                  c == '-' || c == '.';
+        if (!ok) c = '_';
+    }
+    return "covers/" + name;
+}
+
+// Splits a MyAnimeList cover URL into its base image and, for a resized
+// thumbnail, the thumbnail's URL and width
+struct mal_cover {
+    std::string base;
+    std::string thumb;
+    int thumb_width = 0;
+    bool large = false; // `url` was the large variant
+};
+
+static bool parse_mal_cover(const std::string &url, mal_cover &cover)
+{
+    const size_t prefix = strlen(MAL_CDN);
+    if (url.compare(0, prefix, MAL_CDN) != 0) return false;
+    std::string path = url.substr(prefix);
+
+    if (path.compare(0, 2, "r/") == 0) {
+        size_t slash = path.find('/', 2);
+        if (slash == std::string::npos) return false;
+        cover.thumb = url;
+        cover.thumb_width = atoi(path.c_str() + 2);
+        path.erase(0, slash + 1);
+    }
+
+    // Only anime and manga covers come in sizes (not e.g. the placeholder)
+    if (path.compare(0, 13, "images/anime/") != 0 && path.compare(0, 13, "images/manga/") != 0) return false;
+
+    // The signature only applies to the thumbnail
+    size_t query = path.find('?');
+    if (query != std::string::npos) path.erase(query);
+
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos || dot < 2) return false;
+    if (path[dot - 1] == 'l' && isdigit((unsigned char)path[dot - 2])) {
+        path.erase(dot - 1, 1);
+        cover.large = cover.thumb.empty();
+    }
+    cover.base = MAL_CDN + path;
+    return true;
+}
+
+std::string cover_url_for_width(const std::string &url, int width)
+{
+    mal_cover cover;
+    if (!parse_mal_cover(url, cover)) return url;
+    if (!cover.thumb.empty() && width <= cover.thumb_width) return cover.thumb;
+    if (width <= MAL_BASE_WIDTH) return cover.base;
+    size_t dot = cover.base.rfind('.');
+    return cover.base.substr(0, dot) + "l" + cover.base.substr(dot);
+}
+
+int cover_url_width(const std::string &url)
+{
+    mal_cover cover;
+    if (!parse_mal_cover(url, cover)) return 0;
+    if (!cover.thumb.empty()) return cover.thumb_width;
+    return cover.large ? MAL_LARGE_WIDTH : MAL_BASE_WIDTH;
+}
+
+// WebP variant of a MyAnimeList cover, or "" for covers that have none
+static std::string webp_variant(const std::string &url)
+{
+    static const std::string jpg = ".jpg";
+    if (url.compare(0, strlen(MAL_CDN), MAL_CDN) != 0) return "";
+    if (url.size() <= jpg.size() || url.compare(url.size() - jpg.size(), jpg.size(), jpg) != 0) return "";
+    return url.substr(0, url.size() - jpg.size()) + ".webp";
+}
+
+// Counts the covers directory and, if it is over the cap, deletes the least
+// recently used files (by modification time, which a cache hit refreshes)
+// until it is under the target. Caller holds g_cache_mutex.
+static void prune_cache(const std::string &dir)
+{
+    namespace fs = std::filesystem;
+    struct cached_file {
+        fs::file_time_type used;
+        uint64_t size;
+        fs::path path;
+    };
+    std::vector<cached_file> files;
+    uint64_t total = 0;
+
+    std::error_code ec;
+    for (fs::directory_iterator it(fs::u8path(dir), ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code file_ec;
+        if (!it->is_regular_file(file_ec)) continue;
+        uint64_t size = it->file_size(file_ec);
+        fs::file_time_type used = it->last_write_time(file_ec);
+        if (file_ec) continue;
+        files.push_back({used, size, it->path()});
+        total += size;
+    }
+
+    if (total > CACHE_MAX_BYTES) {
+        std::sort(files.begin(), files.end(),
+                  [](const cached_file &a, const cached_file &b) { return a.used < b.used; });
+        size_t removed = 0;
+        for (const auto &f : files) {
+            if (total <= CACHE_TRIM_BYTES) break;
+            std::error_code remove_ec;
+            if (fs::remove(f.path, remove_ec)) {
+                total -= f.size;
+                removed++;
+            }
+        }
+        blog(LOG_INFO, "[MAL] Cover cache over %llu MB; removed %zu least recently used covers",
+             (unsigned long long)(CACHE_MAX_BYTES / (1024 * 1024)), removed);
+    }
+    g_cache_bytes = total;
+}
+
+// Keeps a cover that was just read from the cache off the pruning list
+static void touch_cache_file(const std::string &path)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::last_write_time(fs::u8path(path), fs::file_time_type::clock::now(), ec);
+}
+
+// Downloads `url` into the cache at `path`. Returns the number of bytes
+// written; throws like http_fetch.
+static size_t download(const std::string &url, const std::string &path, int worker)
+{
+    http_request req;
+    req.url = url;
+    req.cancel = &g_stop;
+    req.pacing = http_pacing::asset;
+    std::string body = http_fetch(req);
+
+    std::string tmp = path + ".tmp" + std::to_string(worker);
+    FILE *f = os_fopen(tmp.c_str(), "wb");
+    if (!f) throw std::runtime_error("could not write " + tmp);
+    bool ok = fwrite(body.data(), 1, body.size(), f) == body.size();
+    ok = fclose(f) == 0 && ok;
+    if (!ok || os_rename(tmp.c_str(), path.c_str()) != 0) {
+        os_unlink(tmp.c_str());
+        throw std::runtime_error("could not write " + path);
+    }
+    return body.size();
+}
+
+static void load(cover_job &job, int worker)
+{
+    std::string dir = config_path("covers");
+    if (dir.empty()) {
+        job.state = cover_state::failed;
+        return;
+    }
+    os_mkdirs(dir.c_str());
+    {
+        std::lock_guard<std::mutex> lock(g_cache_mutex);
+        if (!g_cache_scanned) {
+            g_cache_scanned = true;
+            prune_cache(dir);
+        }
+    }
+
+    std::vector<std::string> candidates;
+    std::string webp = job.prefer_webp ? webp_variant(job.url) : "";
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_no_webp.count(webp)) webp.clear();
+    }
+    if (!webp.empty()) candidates.push_back(webp);
+    candidates.push_back(job.url);
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const std::string &url = candidates[i];
+        const bool is_webp = url == webp;
+        std::string path = config_path(cache_file(url));
+        if (path.empty()) break;
+
+        size_t bytes = 0;
+        const bool cached = os_file_exists(path.c_str());
+        if (cached) {
+            touch_cache_file(path);
+        } else {
+            try {
+                bytes = download(url, path, worker);
+                std::lock_guard<std::mutex> lock(g_cache_mutex);
+                g_cache_bytes += bytes;
+                if (g_cache_bytes > CACHE_MAX_BYTES) prune_cache(dir);
+            } catch (const http_status_error &e) {
+                if (e.status == 404 && is_webp) {
+                    {
+                        std::lock_guard<std::mutex> lock(g_mutex);
+                        g_no_webp.insert(webp);
+                    }
+                    std::lock_guard<std::mutex> lock(g_stats_mutex);
+                    g_stats.webp_missing++;
+                    continue;
+                }
+                blog(LOG_WARNING, "[MAL] Could not download cover %s: %s", url.c_str(), e.what());
+                break;
+            } catch (const std::exception &e) {
+                if (!g_stop) blog(LOG_WARNING, "[MAL] Could not download cover %s: %s", url.c_str(), e.what());
+                break;
+            }
+        }
+
+        uint64_t start = os_gettime_ns();
+        gs_image_file_init(&job.image, path.c_str());
+        uint64_t decode_ns = os_gettime_ns() - start;
+        if (!job.image.loaded) {
+            // Drop a damaged file so the next request downloads it again
+            blog(LOG_WARNING, "[MAL] Could not decode cover %s", url.c_str());
+            gs_image_file_free(&job.image);
+            job.image = {};
+            os_unlink(path.c_str());
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_stats_mutex);
+            g_stats.loaded++;
+            if (cached) g_stats.cache_hits++;
+            if (is_webp) {
+                g_stats.webp++;
+                g_stats.webp_bytes += bytes;
+                g_stats.webp_decode_ns += decode_ns;
+            } else {
+                g_stats.jpeg++;
+                g_stats.jpeg_bytes += bytes;
+                g_stats.jpeg_decode_ns += decode_ns;
+            }
+        }
+        job.state = cover_state::ready;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_stats_mutex);
+    g_stats.failed++;
+    job.state = cover_state::failed;
+}
+
+static void worker_main(int worker)
+{
+    for (;;) {
+        cover_handle job;
+        {
+            std::unique_lock<std::mutex> lock(g_mutex);
+            g_wake.wait(lock, [] { return g_stop || !g_queue.empty(); });
+            if (g_stop) return;
+            job = std::move(g_queue.front());
+            g_queue.pop_front();
+        }
+
+        // Nobody is waiting for it any more (list changed, source gone)
+        if (job.use_count() == 1) continue;
+        load(*job, worker);
+    }
+}
+
+cover_handle cover_loader_request(const std::string &url, bool prefer_webp)
+{
+    cover_handle job = std::make_shared<cover_job>();
+    job->url = url;
+    job->prefer_webp = prefer_webp;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_stop) {
+        job->state = cover_state::failed;
+        return job;
+    }
+    if (g_workers.empty()) {
+        for (int i = 0; i < WORKER_COUNT; i++) {
+            g_workers.emplace_back(worker_main, i);
+        }
+    }
+    g_queue.push_back(job);
+    g_wake.notify_one();
+    return job;
+}
+
+gs_image_file_t *cover_loader_take(const cover_handle &job)
+{
+    if (!job || job->state != cover_state::ready) return nullptr;
+    gs_image_file_t *image = new gs_image_file_t(job->image);
+    job->image = {};
+    return image;
+}
+
+void cover_loader_shutdown()
+{
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_stop = true;
+        g_queue.clear();
+        workers.swap(g_workers);
+    }
+    g_wake.notify_all();
+
+    // A download in flight notices g_stop within a second
+    for (auto &t : workers) {
+        t.join();
+    }
+}
+
+cover_loader_stats cover_loader_get_stats()
+{
+    std::lock_guard<std::mutex> lock(g_stats_mutex);
+    return g_stats;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <graphics/image-file.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Module-wide cover loading, shared by every mal_source. Covers are
+// downloaded and decoded on a small pool of worker threads and kept in a
+// disk cache under the module config dir; the graphics thread only turns a
+// decoded cover into a texture (gs_image_file_init_texture). The cache is
+// capped at 256 MB: past that, the least recently used covers are deleted.
+//
+// MyAnimeList's CDN also serves every cover as WebP, which is much smaller
+// than the JPEG the list points at. When asked to, the loader tries the
+// WebP variant first and falls back to the JPEG if the CDN answers 404.
+// Decoding goes through OBS's own image decoder (libavcodec), which handles
+// both formats.
+
+enum class cover_state {
+    pending,
+    ready,  // `image` holds the decoded pixels; no texture yet
+    failed,
+};
+
+struct cover_job {
+    std::string url;
+    bool prefer_webp = false;
+    std::atomic<cover_state> state{cover_state::pending};
+    gs_image_file_t image = {};
+
+    ~cover_job();
+};
+
+// Jobs whose last handle is dropped before a worker gets to them are skipped
+typedef std::shared_ptr<cover_job> cover_handle;
+
+struct cover_loader_stats {
+    uint64_t loaded;      // covers decoded
+    uint64_t cache_hits;  // of which read from the disk cache
+    uint64_t failed;
+    uint64_t webp;        // covers downloaded as WebP...
+    uint64_t webp_bytes;
+    uint64_t webp_decode_ns;
+    uint64_t jpeg;        // ...and as the list's original format
+    uint64_t jpeg_bytes;
+    uint64_t jpeg_decode_ns;
+    uint64_t webp_missing; // WebP variants answered with 404
+};
+
+// MyAnimeList serves each cover as a signed resized thumbnail (the
+// /r/{w}x{h}/ URLs in list pages), the base image (~225 px wide) and a large
+// variant ("l" before the extension, ~425 px wide). Returns the smallest of
+// those at least `width` pixels wide, from any of the cover's URLs; other
+// hosts' URLs are returned unchanged.
+std::string cover_url_for_width(const std::string &url, int width);
+
+// Nominal width of the MyAnimeList variant `url` points at, or 0 if unknown
+int cover_url_width(const std::string &url);
+
+cover_handle cover_loader_request(const std::string &url, bool prefer_webp);
+
+// Hands over the decoded image of a ready job. The caller creates its
+// texture inside the graphics context and frees it with gs_image_file_free.
+gs_image_file_t *cover_loader_take(const cover_handle &job);
+
+// Stops the workers, abandoning queued covers; called at module unload.
+void cover_loader_shutdown();
+
+cover_loader_stats cover_loader_get_stats();
@@ -0,0 +1,187 @@
+#include "http-client.hpp"
+#include "http-limiter.hpp"
+#include <curl/curl.h>
+#include <stdexcept>
+#include <obs-module.h>
+
+// Bounds for every request
+static const long CONNECT_TIMEOUT_S = 10;
+static const long TRANSFER_TIMEOUT_S = 30;
+static const long LOW_SPEED_LIMIT_BPS = 256; // slower than this...
+static const long LOW_SPEED_TIME_S = 15;     // ...for this long aborts
+
+struct write_target {
+    CURL *curl;
+    const http_data_fn *on_data;
+    bool stopped;
+    uint64_t decoded;
+};
+
+static std::atomic<uint64_t> g_requests(0);
+static std::atomic<uint64_t> g_received(0);
+static std::atomic<uint64_t> g_decoded(0);
+static thread_local http_transfer_stats t_stats;
+
+static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+    write_target *target = (write_target *)userp;
+    target->decoded += size * nmemb;
+
+    // Error bodies are never handed on; the status is checked afterwards
+    long status = 0;
+    curl_easy_getinfo(target->curl, CURLINFO_RESPONSE_CODE, &status);
+    if (status < 200 || status >= 300) return size * nmemb;
+
+    if (!(*target->on_data)((const char *)contents, size * nmemb)) {
+        target->stopped = true;
+        return 0;
+    }
+    return size * nmemb;
+}
+
+// Aborts the transfer once the owner asked to cancel; curl calls this
+// several times a second, including while connecting
+static int XferInfoCallback(void *clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+    const std::atomic<bool> *cancel = (const std::atomic<bool> *)clientp;
+    return (cancel && *cancel) ? 1 : 0;
+}
+
+// Runs one request; idle_timeout_s > 0 makes it a stream without an
+// overall time limit
+static void perform(const http_request &req, long idle_timeout_s, const http_data_fn &on_data)
+{
+    CURL *curl;
+    CURLcode res;
+    
+    // Paced per host; while the host keeps failing this throws without
+    // touching the network and callers keep what they already have
+    const std::string host = http_limiter_host(req.url);
+    http_permit permit = http_limiter_acquire(host, req.pacing, req.cancel);
+    if (permit == http_permit::cancelled) {
+        throw std::runtime_error("cancelled");
+    }
+    if (permit != http_permit::granted) {
+        throw std::runtime_error("requests to " + host + " are paused after repeated failures");
+    }
+
+    long status = 0;
+    curl_off_t retry_after = 0;
+    curl_off_t received = 0;
+    struct curl_slist *headers = nullptr;
+    curl = curl_easy_init();
+    write_target target = {curl, &on_data, false, 0};
+    if(curl) {
+        curl_easy_setopt(curl, CURLOPT_URL, req.url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &target);
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36");
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+        // "" offers every encoding this curl build can decode
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+
+        for (const auto &h : req.headers) {
+            headers = curl_slist_append(headers, h.c_str());
+        }
+        if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        if (!req.body.empty()) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, req.body.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)req.body.size());
+        }
+
+        // Never wait on a server indefinitely: bound connecting, the whole
+        // transfer, and stalls, and let the owner abort at any time
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT_S);
+        if (idle_timeout_s > 0) {
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, idle_timeout_s);
+        } else {
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, TRANSFER_TIMEOUT_S);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, LOW_SPEED_LIMIT_BPS);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, LOW_SPEED_TIME_S);
+        }
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, XferInfoCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, (void *)req.cancel);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        
+        res = curl_easy_perform(curl);
+        curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+        g_requests++;
+        g_received += (uint64_t)received;
+        g_decoded += target.decoded;
+        t_stats.requests++;
+        t_stats.received += (uint64_t)received;
+        t_stats.decoded += target.decoded;
+        if(res == CURLE_ABORTED_BY_CALLBACK) {
+            curl_easy_cleanup(curl);
+            curl_slist_free_all(headers);
+            http_limiter_report(host, req.pacing, -1, 0);
+            throw std::runtime_error("cancelled");
+        } else if(res != CURLE_OK && !(res == CURLE_WRITE_ERROR && target.stopped)) {
+            blog(LOG_ERROR, "curl_easy_perform() failed: %s", curl_easy_strerror(res));
+        } else {
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+            curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retry_after);
+        }
+        curl_easy_cleanup(curl);
+    }
+    curl_slist_free_all(headers);
+    
+    http_limiter_report(host, req.pacing, status, (int64_t)retry_after);
+
+    // An error page is not a list; make sure it never replaces one
+    if (status == 0) {
+        throw std::runtime_error("no response from " + host);
+    }
+    if (status < 200 || status >= 300) {
+        throw http_status_error("HTTP " + std::to_string(status) + " from " + host, status);
+    }
+}
+
+std::string http_fetch(const http_request &req)
+{
+    std::string readBuffer;
+    perform(req, 0, [&](const char *data, size_t size) {
+        readBuffer.append(data, size);
+        return true;
+    });
+    return readBuffer;
+}
+
+void http_stream(const http_request &req, long idle_timeout_s, const http_data_fn &on_data)
+{
+    perform(req, idle_timeout_s, on_data);
+}
+
+http_transfer_stats operator-(const http_transfer_stats &a, const http_transfer_stats &b)
+{
+    http_transfer_stats d;
+    d.requests = a.requests - b.requests;
+    d.received = a.received - b.received;
+    d.decoded = a.decoded - b.decoded;
+    return d;
+}
+
+http_transfer_stats http_get_stats()
+{
+    http_transfer_stats s;
+    s.requests = g_requests;
+    s.received = g_received;
+    s.decoded = g_decoded;
+    return s;
+}
+
+http_transfer_stats http_thread_stats()
+{
+    return t_stats;
+}
+
+void http_thread_stats_add(const http_transfer_stats &stats)
+{
+    t_stats.requests += stats.requests;
+    t_stats.received += stats.received;
+    t_stats.decoded += stats.decoded;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "http-limiter.hpp"
+
+// One bounded, cancellable HTTP request, paced through the per-host rate
+// limiter (http-limiter.hpp). Used by every list backend. Responses are
+// requested compressed (every encoding curl supports: gzip, and brotli and
+// zstd where built in) and handed on decompressed.
+
+struct http_request {
+    std::string url;
+    std::string body;                 // POSTed when not empty
+    std::vector<std::string> headers; // e.g. "Content-Type: application/json"
+    const std::atomic<bool> *cancel = nullptr;
+    http_pacing pacing = http_pacing::api;
+};
+
+// Thrown for a response with a non-2xx status
+class http_status_error : public std::runtime_error {
+public:
+    http_status_error(const std::string &what, long status) : std::runtime_error(what), status(status) {}
+    long status;
+};
+
+// Returns the body of a 2xx response. Throws std::runtime_error on a
+// transport error, cancellation, or while the host's circuit breaker is
+// open, and http_status_error on a non-2xx status.
+std::string http_fetch(const http_request &req);
+
+// Called with each chunk of a streamed 2xx response body; returning false
+// ends the stream
+typedef std::function<bool(const char *data, size_t size)> http_data_fn;
+
+// Like http_fetch, but hands the body to on_data as it arrives. With
+// idle_timeout_s > 0 there is no overall time limit, only an idle one: the
+// stream is dropped after idle_timeout_s without a byte; with 0 the usual
+// bounds apply. Returns when the server or on_data ends the stream; throws
+// like http_fetch otherwise.
+void http_stream(const http_request &req, long idle_timeout_s, const http_data_fn &on_data);
+
+struct http_transfer_stats {
+    uint64_t requests = 0;
+    uint64_t received = 0; // body bytes on the wire, compressed
+    uint64_t decoded = 0;  // body bytes after decompression
+};
+
+http_transfer_stats operator-(const http_transfer_stats &a, const http_transfer_stats &b);
+
+// Totals of every request made so far
+http_transfer_stats http_get_stats();
+
+// Totals of the requests made on the calling thread; a fetch diffs these to
+// measure itself
+http_transfer_stats http_thread_stats();
+
+// Counts requests made on a helper thread towards the calling thread
+void http_thread_stats_add(const http_transfer_stats &stats);
@@ -0,0 +1,139 @@
+#include "http-limiter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <obs-module.h>
+#include <util/platform.h>
+
+struct pacing_policy {
+    double tokens_per_second; // steady rate per host...
+    double burst;             // ...after a burst of this many
+    bool breaker;             // failures in a row open the circuit breaker
+};
+
+// Indexed by http_pacing
+static const pacing_policy POLICIES[] = {
+    {1.0, 4.0, true},     // api
+    {20.0, 20.0, false},  // asset
+};
+
+// Backoff after the n-th failure in a row: BACKOFF_BASE * 2^(n-1), capped,
+// then scaled by a random factor in [0.5, 1.5) so sources do not retry in step
+static const double BACKOFF_BASE_S = 2.0;
+static const double BACKOFF_MAX_S = 300.0;
+
+// Failures in a row that open the breaker, and how long it stays open
+static const int BREAKER_THRESHOLD = 5;
+static const double BREAKER_OPEN_S = 600.0;
+
+// Waits are sliced so cancellation is noticed quickly
+static const uint64_t WAIT_SLICE_NS = 50000000ULL;
+
+struct HostState {
+    double tokens = 0.0; // filled to the burst on first use
+    uint64_t refilled_at = 0;
+    uint64_t backoff_until = 0;
+    int failures = 0;
+    uint64_t breaker_until = 0;
+    bool trial_in_flight = false;
+};
+
+static std::mutex g_mutex;
+static std::unordered_map<std::string, HostState> g_hosts[2]; // by http_pacing
+
+static uint64_t seconds_to_ns(double s)
+{
+    return (uint64_t)(s * 1000000000.0);
+}
+
+static double jitter()
+{
+    static std::mt19937 rng(std::random_device{}());
+    std::uniform_real_distribution<double> dist(0.5, 1.5);
+    return dist(rng);
+}
+
+http_permit http_limiter_acquire(const std::string &host, http_pacing pacing, const std::atomic<bool> *cancel)
+{
+    const pacing_policy &policy = POLICIES[(int)pacing];
+    for (;;) {
+        if (cancel && *cancel) return http_permit::cancelled;
+
+        uint64_t wait_ns = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            HostState &h = g_hosts[(int)pacing][host];
+            uint64_t now = os_gettime_ns();
+
+            if (policy.breaker && h.failures >= BREAKER_THRESHOLD) {
+                // Open: fail fast. Cooled down: let one trial through.
+                if (now < h.breaker_until || h.trial_in_flight) return http_permit::rejected;
+                h.trial_in_flight = true;
+                return http_permit::granted;
+            }
+
+            if (h.refilled_at == 0) {
+                h.refilled_at = now;
+                h.tokens = policy.burst;
+            }
+            h.tokens = std::min(policy.burst,
+                                h.tokens + (double)(now - h.refilled_at) * 1e-9 * policy.tokens_per_second);
+            h.refilled_at = now;
+
+            if (now < h.backoff_until) {
+                wait_ns = h.backoff_until - now;
+            } else if (h.tokens >= 1.0) {
+                h.tokens -= 1.0;
+                return http_permit::granted;
+            } else {
+                wait_ns = seconds_to_ns((1.0 - h.tokens) / policy.tokens_per_second);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(wait_ns, WAIT_SLICE_NS)));
+    }
+}
+
+void http_limiter_report(const std::string &host, http_pacing pacing, long status, int64_t retry_after_s)
+{
+    const pacing_policy &policy = POLICIES[(int)pacing];
+    std::lock_guard<std::mutex> lock(g_mutex);
+    HostState &h = g_hosts[(int)pacing][host];
+    h.trial_in_flight = false;
+    if (status < 0) return;
+
+    bool failed = pacing == http_pacing::asset ? status == 429 || status == 503
+                                               : status == 0 || status == 429 || status >= 500;
+    if (!failed) {
+        if (h.failures >= BREAKER_THRESHOLD) blog(LOG_INFO, "[MAL] %s is reachable again", host.c_str());
+        h.failures = 0;
+        h.backoff_until = 0;
+        return;
+    }
+
+    h.failures++;
+    double backoff = std::min(BACKOFF_MAX_S, BACKOFF_BASE_S * (double)(1ULL << std::min(h.failures - 1, 16)));
+    backoff *= jitter();
+    backoff = std::max(backoff, (double)retry_after_s);
+
+    uint64_t now = os_gettime_ns();
+    h.backoff_until = now + seconds_to_ns(backoff);
+    if (policy.breaker && h.failures >= BREAKER_THRESHOLD) {
+        h.breaker_until = now + seconds_to_ns(std::max(BREAKER_OPEN_S, (double)retry_after_s));
+        blog(LOG_WARNING, "[MAL] %s failed %d times in a row (last status %ld); pausing requests for %.0f s",
+             host.c_str(), h.failures, status, std::max(BREAKER_OPEN_S, (double)retry_after_s));
+    } else {
+        blog(LOG_WARNING, "[MAL] %s answered %ld; backing off %.1f s", host.c_str(), status, backoff);
+    }
+}
+
+std::string http_limiter_host(const std::string &url)
+{
+    size_t start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+    size_t end = url.find_first_of(":/?#", start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Process-wide pacing of requests per host, shared by every source.
+//
+// Each host has a token bucket (a small burst, then a steady rate). Failed
+// requests (429, 5xx, transport errors) push the host into a jittered
+// exponential backoff, stretched to the server's Retry-After when it sends
+// one. After several failures in a row the host's circuit breaker opens and
+// requests fail fast until it cools down; one trial request is then let
+// through, and its outcome closes or re-opens the breaker. While requests
+// fail fast, callers keep serving what they already have (the list store
+// keeps its last snapshot on a failed fetch).
+//
+// Static assets (cover images on a CDN) are paced separately from the
+// list APIs of the same site: much higher rate and burst, and only the
+// server's own throttling (429, 503) backs them off. Other failures are
+// per file, so they neither slow down other covers nor open a breaker; the
+// cover's owner decides when to ask again.
+
+enum class http_pacing {
+    api,   // list pages and API calls
+    asset, // static files such as covers
+};
+
+enum class http_permit {
+    granted,   // send the request, then report its outcome
+    rejected,  // breaker open; do not send
+    cancelled, // `cancel` was set while waiting
+};
+
+// Waits until a request to `host` may be sent. Polls `cancel` (may be null)
+// while waiting.
+http_permit http_limiter_acquire(const std::string &host, http_pacing pacing, const std::atomic<bool> *cancel);
+
+// Reports the outcome of a granted request. `status` is the HTTP status,
+// 0 for a transport error, or -1 if the request was cancelled (no outcome);
+// `retry_after_s` is the server's Retry-After in seconds, or 0 if absent.
+void http_limiter_report(const std::string &host, http_pacing pacing, long status, int64_t retry_after_s);
+
+// Host part of an http(s) URL, e.g. "myanimelist.net".
+std::string http_limiter_host(const std::string &url);
@@ -0,0 +1,110 @@
+#include "list-backend.hpp"
+#include "anilist-backend.hpp"
+#include "mal-api-backend.hpp"
+#include "companion-backend.hpp"
+#include <algorithm>
+#include <tuple>
+
+// Scrapes the data-items JSON out of MyAnimeList's list pages; one page per
+// status and media
+class MALWebBackend : public ListBackend {
+public:
+    explicit MALWebBackend(const std::string &host) : host_(host) {}
+
+protected:
+    bool groupsStatuses() const override { return false; }
+
+    std::vector<MALEntry> fetchMedia(const std::string &username, const std::string &media,
+                                     const std::string &status, const std::atomic<bool> *cancel) override
+    {
+        MALFetcher fetcher(username, cancel, host_);
+        return fetcher.fetchList(status, media);
+    }
+
+private:
+    std::string host_;
+};
+
+bool operator<(const list_key &a, const list_key &b)
+{
+    return std::tie(a.backend, a.endpoint, a.username, a.media, a.status, a.first_status) <
+           std::tie(b.backend, b.endpoint, b.username, b.media, b.status, b.first_status);
+}
+
+std::unique_ptr<ListBackend> list_backend_create(const list_key &key)
+{
+    if (key.backend == "anilist") return std::unique_ptr<ListBackend>(new AniListBackend(key.endpoint));
+    if (key.backend == "mal_api") return std::unique_ptr<ListBackend>(new MALApiBackend(key.client_id, key.endpoint));
+    if (key.backend == "companion") return std::unique_ptr<ListBackend>(new CompanionBackend(key.endpoint));
+    return std::unique_ptr<ListBackend>(new MALWebBackend(key.endpoint));
+}
+
+std::string list_status_for_media(const std::string &status, const std::string &media)
+{
+    if (media == "manga" && status == "WATCHING") return "READING";
+    if (media == "anime" && status == "READING") return "WATCHING";
+    return status;
+}
+
+// Statuses of an "ALL" key in display order
+static std::vector<std::string> statuses_in_order(const list_key &key)
+{
+    std::vector<std::string> statuses = {"WATCHING", "COMPLETED", "PAUSED", "DROPPED", "PLANNING"};
+    auto first = std::find(statuses.begin(), statuses.end(), key.first_status);
+    if (first != statuses.end()) std::rotate(statuses.begin(), first, first + 1);
+    return statuses;
+}
+
+void list_sort_for_display(const list_key &key, std::vector<MALEntry> &entries)
+{
+    const auto statuses = statuses_in_order(key);
+    auto rank = [&](const MALEntry &e) {
+        auto it = std::find(statuses.begin(), statuses.end(), list_status_for_media(e.status, "anime"));
+        return (size_t)(it - statuses.begin()) * 2 + (e.media == "anime" ? 1 : 0);
+    };
+    std::stable_sort(entries.begin(), entries.end(),
+                     [&](const MALEntry &a, const MALEntry &b) { return rank(a) < rank(b); });
+}
+
+std::vector<MALEntry> ListBackend::fetch(const list_key &key, const std::atomic<bool> *cancel,
+                                         const list_page_fn &on_page)
+{
+    std::vector<std::string> medias;
+    if (key.media == "both") {
+        medias = {"manga", "anime"};
+    } else {
+        medias = {key.media};
+    }
+
+    // The requests the key is made of, in display order
+    struct request {
+        std::string status;
+        std::string media;
+    };
+    std::vector<request> requests;
+    const bool grouped = key.status == "ALL" && groupsStatuses();
+    if (key.status == "ALL" && !grouped) {
+        // Fetch all status categories separately to get status info per
+        // entry, starting with the one the user wants to see first
+        for (const auto &status : statuses_in_order(key)) {
+            for (const auto &media : medias) {
+                requests.push_back({list_status_for_media(status, media), media});
+            }
+        }
+    } else if (key.media == "both" || grouped) {
+        for (const auto &media : medias) {
+            requests.push_back({grouped ? key.status : list_status_for_media(key.status, media), media});
+        }
+    } else {
+        requests.push_back({key.status, key.media});
+    }
+
+    std::vector<MALEntry> entries;
+    for (size_t i = 0; i < requests.size(); i++) {
+        auto list = fetchMedia(key.username, requests[i].media, requests[i].status, cancel);
+        entries.insert(entries.end(), list.begin(), list.end());
+        if (grouped) list_sort_for_display(key, entries);
+        if (i + 1 < requests.size() && !list.empty() && on_page) on_page(entries);
+    }
+    return entries;
+}
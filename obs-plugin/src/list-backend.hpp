@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mal-fetcher.hpp"
+
+// Where list entries come from. A backend only knows how to fetch one
+// media's list; ListBackend::fetch plans the requests for a whole key and
+// puts the result in display order, whichever backend is used.
+
+struct list_key {
+    std::string backend; // list_backend_create name
+    std::string username;
+    std::string media;
+    std::string status;
+    std::string first_status; // status shown first when status is "ALL", else empty
+
+    // Server URL for the companion backend. The other backends use it, when
+    // set, in place of their public host (the offline checks point them at
+    // replay-server.js); the plugin leaves it empty for them.
+    std::string endpoint;
+
+    // Credential for backends that need one; not part of the list's identity
+    std::string client_id;
+};
+
+// Orders keys by identity (everything but client_id)
+bool operator<(const list_key &a, const list_key &b);
+
+// Called with every entry fetched so far, after each request but the last
+typedef std::function<void(const std::vector<MALEntry> &so_far)> list_page_fn;
+
+class ListBackend {
+public:
+    virtual ~ListBackend() {}
+
+    // Fetches the whole key, in display order: status by status (starting
+    // with key.first_status for "ALL"), manga before anime within a status.
+    // Throws std::runtime_error if any request fails or `cancel` gets set.
+    std::vector<MALEntry> fetch(const list_key &key, const std::atomic<bool> *cancel, const list_page_fn &on_page);
+
+protected:
+    // True if one request returns every status of a media, grouped; "ALL"
+    // then costs one request per media instead of one per status and media
+    virtual bool groupsStatuses() const = 0;
+
+    // Entries of one media ("manga" or "anime") with the given status, or
+    // with every status if `status` is "ALL" (only asked of backends that
+    // group statuses). Entry statuses use MAL's names, e.g. READING for
+    // manga and WATCHING for anime in progress.
+    virtual std::vector<MALEntry> fetchMedia(const std::string &username, const std::string &media,
+                                             const std::string &status, const std::atomic<bool> *cancel) = 0;
+};
+
+// Backend for key.backend: "mal" (MyAnimeList web pages), "mal_api"
+// (MyAnimeList API v2, using key.client_id), "anilist" or "companion" (the
+// local server.js at key.endpoint); unknown names fall back to "mal"
+std::unique_ptr<ListBackend> list_backend_create(const list_key &key);
+
+// MAL calls the in-progress status READING for manga and WATCHING for anime
+std::string list_status_for_media(const std::string &status, const std::string &media);
+
+// Puts entries in the order ListBackend::fetch returns them: by status
+// (key.first_status first), manga before anime within a status, keeping the
+// order within each group. For lists that arrive grouped or pushed.
+void list_sort_for_display(const list_key &key, std::vector<MALEntry> &entries);
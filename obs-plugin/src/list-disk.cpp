@@ -0,0 +1,182 @@
+#include "list-disk.hpp"
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <obs-module.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+static const char LIST_DISK_MAGIC[4] = {'M', 'A', 'L', 'L'};
+static const uint32_t LIST_DISK_VERSION = 1;
+
+// Numbers the temporary file of each save, so two threads saving the same
+// key (a fetch and a companion push) never write or rename each other's file
+static std::atomic<uint32_t> g_save_serial{0};
+
+struct list_disk_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t blob_size;
+};
+
+struct list_disk_string {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct list_disk_record {
+    list_disk_string id;
+    list_disk_string title;
+    list_disk_string cover;
+    list_disk_string status;
+    list_disk_string media;
+    int32_t progress;
+};
+
+// 64-bit FNV-1a, to name a key's endpoint URL in its file name
+static uint64_t fnv1a(const std::string &s)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Usernames are limited to letters, digits, '_' and '-' on MAL; anything
+// else is replaced so a key can never escape the lists directory. The
+// endpoint is part of the key's identity; it goes in as a hash, since
+// sanitizing a URL could map two of them to one name.
+static std::string file_name(const list_key &key)
+{
+    std::string name = "lists/" + key.backend + "-" + key.username + "-" + key.media + "-" + key.status;
+    if (!key.first_status.empty()) name += "-" + key.first_status;
+    if (!key.endpoint.empty()) {
+        char hash[24];
+        snprintf(hash, sizeof(hash), "-%016" PRIx64, fnv1a(key.endpoint));
+        name += hash;
+    }
+    name += ".bin";
+    for (size_t i = 6; i < name.size(); i++) {
+        char c = name[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                  c == '_' || c == '-' || c == '.';
+        if (!ok) name[i] = '_';
+    }
+    return name;
+}
+
+static std::string config_path(const std::string &file)
+{
+    char *path = obs_module_config_path(file.c_str());
+    if (!path) return std::string();
+    std::string result = path;
+    bfree(path);
+    return result;
+}
+
+static list_disk_string add_string(std::string &blob, const std::string &s)
+{
+    list_disk_string ref = {(uint32_t)blob.size(), (uint32_t)s.size()};
+    blob += s;
+    return ref;
+}
+
+static bool get_string(const std::string &blob, const list_disk_string &ref, std::string &out)
+{
+    if (ref.offset > blob.size() || ref.length > blob.size() - ref.offset) return false;
+    out.assign(blob, ref.offset, ref.length);
+    return true;
+}
+
+bool list_disk_load(const list_key &key, std::vector<MALEntry> &entries)
+{
+    std::string path = config_path(file_name(key));
+    if (path.empty()) return false;
+
+    FILE *f = os_fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    list_disk_header header;
+    std::vector<list_disk_record> records;
+    std::string blob;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              memcmp(header.magic, LIST_DISK_MAGIC, sizeof(header.magic)) == 0 &&
+              header.version == LIST_DISK_VERSION && header.count < (1u << 20) &&
+              header.blob_size < (64u << 20);
+    if (ok) {
+        records.resize(header.count);
+        blob.resize(header.blob_size);
+        ok = (header.count == 0 || fread(records.data(), sizeof(list_disk_record), header.count, f) == header.count) &&
+             (header.blob_size == 0 || fread(&blob[0], 1, header.blob_size, f) == header.blob_size);
+    }
+    fclose(f);
+
+    if (!ok) {
+        blog(LOG_WARNING, "[MAL] Ignoring unreadable list snapshot %s", path.c_str());
+        return false;
+    }
+
+    entries.clear();
+    entries.reserve(records.size());
+    for (const auto &r : records) {
+        MALEntry entry;
+        if (!get_string(blob, r.id, entry.id) || !get_string(blob, r.title, entry.title) ||
+            !get_string(blob, r.cover, entry.coverImage) || !get_string(blob, r.status, entry.status) ||
+            !get_string(blob, r.media, entry.media)) {
+            blog(LOG_WARNING, "[MAL] Ignoring corrupt list snapshot %s", path.c_str());
+            entries.clear();
+            return false;
+        }
+        entry.progress = r.progress;
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+void list_disk_save(const list_key &key, const std::vector<MALEntry> &entries)
+{
+    std::string dir = config_path("lists");
+    std::string path = config_path(file_name(key));
+    if (dir.empty() || path.empty()) return;
+    os_mkdirs(dir.c_str());
+
+    std::vector<list_disk_record> records;
+    std::string blob;
+    records.reserve(entries.size());
+    for (const auto &entry : entries) {
+        list_disk_record r;
+        r.id = add_string(blob, entry.id);
+        r.title = add_string(blob, entry.title);
+        r.cover = add_string(blob, entry.coverImage);
+        r.status = add_string(blob, entry.status);
+        r.media = add_string(blob, entry.media);
+        r.progress = entry.progress;
+        records.push_back(r);
+    }
+
+    list_disk_header header;
+    memcpy(header.magic, LIST_DISK_MAGIC, sizeof(header.magic));
+    header.version = LIST_DISK_VERSION;
+    header.count = (uint32_t)records.size();
+    header.blob_size = (uint32_t)blob.size();
+
+    std::string tmp = path + ".tmp" + std::to_string(++g_save_serial);
+    FILE *f = os_fopen(tmp.c_str(), "wb");
+    if (!f) {
+        blog(LOG_WARNING, "[MAL] Could not write list snapshot %s", tmp.c_str());
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              (records.empty() || fwrite(records.data(), sizeof(list_disk_record), records.size(), f) == records.size()) &&
+              (blob.empty() || fwrite(blob.data(), 1, blob.size(), f) == blob.size());
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok || os_rename(tmp.c_str(), path.c_str()) != 0) {
+        blog(LOG_WARNING, "[MAL] Could not write list snapshot %s", path.c_str());
+        os_unlink(tmp.c_str());
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "list-store.hpp"
+
+// Last good list per key, kept under the module config dir so a source can
+// show something on its first frame, before any network round-trip.
+//
+// File layout (native endianness, all fields 32-bit):
+//   header   magic "MALL", version, entry count, string blob size
+//   records  one fixed-size record per entry: (offset, length) into the blob
+//            for id, title, cover, status and media, then progress
+//   blob     the strings, back to back, not NUL-terminated
+// Fixed-size records let the file be mapped and indexed in place; here it
+// is read in one go and validated before use.
+
+// Returns false if there is no usable file for the key.
+bool list_disk_load(const list_key &key, std::vector<MALEntry> &entries);
+
+// Replaces the file for the key; written to a temporary file of its own and
+// renamed, so concurrent saves of a key leave one complete file.
+void list_disk_save(const list_key &key, const std::vector<MALEntry> &entries);
@@ -0,0 +1,199 @@
+#include "list-store.hpp"
+#include "list-disk.hpp"
+#include "http-client.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <obs-module.h>
+#include <util/platform.h>
+
+struct ListStoreEntry {
+    list_snapshot snapshot;
+    uint64_t fetched_at = 0;
+    bool in_flight = false;
+
+    // Pages fetched so far by the in-flight fetch of a key that had no
+    // snapshot yet; `progress` counts publications so waiters see each one
+    list_snapshot partial;
+    uint64_t progress = 0;
+
+    // Fetches that ran to the end (succeeded or failed); an abandoned one
+    // does not count, so its waiters know to take over
+    uint64_t finished = 0;
+
+    // list_store_publish calls for this key
+    uint64_t publications = 0;
+};
+
+static std::mutex g_mutex;
+static std::condition_variable g_done;
+static std::map<list_key, ListStoreEntry> g_lists;
+static uint64_t g_fetches = 0;
+static uint64_t g_shared = 0;
+static uint64_t g_received = 0;
+static uint64_t g_decoded = 0;
+
+// Waiters wake at least this often to notice cancellation
+static const std::chrono::milliseconds CANCEL_POLL(100);
+
+list_snapshot list_store_get(const list_key &key, uint64_t max_age_ns, const std::atomic<bool> *cancel,
+                             const list_progress_fn &on_partial)
+{
+    std::unique_lock<std::mutex> lock(g_mutex);
+    ListStoreEntry &entry = g_lists[key];
+
+    // Someone else is fetching this key; share their result, and their
+    // pages as they arrive
+    while (entry.in_flight) {
+        const uint64_t finished = entry.finished;
+        uint64_t seen = 0;
+        while (entry.in_flight) {
+            if (cancel && *cancel) return nullptr;
+            if (on_partial && entry.partial && entry.progress != seen) {
+                seen = entry.progress;
+                list_snapshot partial = entry.partial;
+                lock.unlock();
+                on_partial(partial);
+                lock.lock();
+                continue;
+            }
+            g_done.wait_for(lock, CANCEL_POLL);
+        }
+        if (entry.finished != finished) {
+            g_shared++;
+            return entry.snapshot;
+        }
+        // The fetcher was cancelled before it got anywhere: take the fetch
+        // over below, unless another waiter already has
+    }
+
+    if (entry.snapshot && os_gettime_ns() - entry.fetched_at < max_age_ns) {
+        g_shared++;
+        return entry.snapshot;
+    }
+
+    // Pages are only shown one by one on a first load; a refresh replaces
+    // the current list in one go rather than shrinking it meanwhile
+    const bool progressive = !entry.snapshot || entry.snapshot->empty();
+    entry.in_flight = true;
+    entry.partial = nullptr;
+    g_fetches++;
+    lock.unlock();
+
+    auto publish_page = [&](const std::vector<MALEntry> &so_far) {
+        if (!progressive) return;
+        list_snapshot partial = std::make_shared<const std::vector<MALEntry>>(so_far);
+        {
+            std::lock_guard<std::mutex> guard(g_mutex);
+            entry.partial = partial;
+            entry.progress++;
+        }
+        g_done.notify_all();
+        if (on_partial) on_partial(partial);
+    };
+
+    std::vector<MALEntry> entries;
+    bool failed = false;
+    const http_transfer_stats before = http_thread_stats();
+    try {
+        entries = list_backend_create(key)->fetch(key, cancel, publish_page);
+    } catch (const std::exception &e) {
+        failed = true;
+        if (cancel && *cancel) {
+            // Nothing was learned; leave the key stale so the next caller,
+            // or a waiter woken below, fetches it again
+            lock.lock();
+            entry.in_flight = false;
+            entry.partial = nullptr;
+            lock.unlock();
+            g_done.notify_all();
+            return nullptr;
+        }
+        blog(LOG_ERROR, "[MAL] Failed to fetch list for '%s': %s", key.username.c_str(), e.what());
+    }
+
+    const http_transfer_stats transfer = http_thread_stats() - before;
+    blog(LOG_INFO, "[MAL] Refreshed %s list for '%s': %llu requests, %.1f KB received, %.1f KB decompressed",
+         key.backend.c_str(), key.username.c_str(), (unsigned long long)transfer.requests,
+         transfer.received / 1024.0, transfer.decoded / 1024.0);
+
+    // A fetch that succeeded is the list, even an empty one (backends throw
+    // rather than return a list they could not read). On failure keep
+    // serving what we had: the last snapshot, else the pages that did arrive.
+    lock.lock();
+    g_received += transfer.received;
+    g_decoded += transfer.decoded;
+    if (!failed) {
+        entry.snapshot = std::make_shared<const std::vector<MALEntry>>(std::move(entries));
+    } else if (!entry.snapshot) {
+        entry.snapshot = entry.partial ? entry.partial : list_store_empty();
+    }
+    entry.fetched_at = os_gettime_ns();
+    entry.in_flight = false;
+    entry.partial = nullptr;
+    entry.finished++;
+    list_snapshot result = entry.snapshot;
+    lock.unlock();
+
+    g_done.notify_all();
+
+    if (!failed) {
+        list_disk_save(key, *result);
+    }
+    return result;
+}
+
+list_snapshot list_store_peek(const list_key &key)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_lists.find(key);
+        if (it != g_lists.end() && it->second.snapshot) return it->second.snapshot;
+    }
+
+    std::vector<MALEntry> entries;
+    if (!list_disk_load(key, entries)) return nullptr;
+    blog(LOG_INFO, "[MAL] Loaded %zu saved entries for '%s'", entries.size(), key.username.c_str());
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    ListStoreEntry &entry = g_lists[key];
+    // A fetch may have finished while the file was read
+    if (!entry.snapshot) {
+        entry.snapshot = std::make_shared<const std::vector<MALEntry>>(std::move(entries));
+        entry.fetched_at = 0;
+    }
+    return entry.snapshot;
+}
+
+void list_store_publish(const list_key &key, list_snapshot snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        ListStoreEntry &entry = g_lists[key];
+        entry.snapshot = snapshot;
+        entry.fetched_at = os_gettime_ns();
+        entry.publications++;
+    }
+    g_done.notify_all();
+    list_disk_save(key, *snapshot);
+}
+
+uint64_t list_store_publications(const list_key &key)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_lists.find(key);
+    return it == g_lists.end() ? 0 : it->second.publications;
+}
+
+list_snapshot list_store_empty()
+{
+    static const list_snapshot empty = std::make_shared<const std::vector<MALEntry>>();
+    return empty;
+}
+
+list_store_stats list_store_get_stats()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return list_store_stats{g_fetches, g_shared, g_lists.size(), g_received, g_decoded};
+}
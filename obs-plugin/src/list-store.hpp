@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "list-backend.hpp"
+
+// Module-wide store of fetched lists, keyed by list_key (backend, username,
+// media, status).
+// Every mal_source asking for the same key shares one immutable snapshot,
+// and concurrent requests for a key collapse into a single fetch: the first
+// caller fetches on its own thread while the others wait for its result.
+// Each successful fetch is also saved to disk (see list-disk.hpp).
+
+// Snapshots are never modified once published; holders keep them alive.
+typedef std::shared_ptr<const std::vector<MALEntry>> list_snapshot;
+
+struct list_store_stats {
+    uint64_t fetches; // network round-trips actually made
+    uint64_t shared;  // requests answered from a fresh or in-flight fetch
+    size_t keys;
+    uint64_t received; // response bytes of those fetches on the wire
+    uint64_t decoded;  // the same bytes decompressed
+};
+
+// Called with the pages fetched so far while a first load is in flight
+typedef std::function<void(const list_snapshot &partial)> list_progress_fn;
+
+// Returns the snapshot for `key`, fetching it if the stored one is older
+// than max_age_ns (or missing). Blocks while a fetch for the key is in
+// flight; setting `cancel` aborts the wait, or this caller's own fetch, and
+// nullptr is returned. A failed fetch keeps serving the previous snapshot.
+// When the key has no snapshot yet, on_partial (if set) receives the list
+// after each fetched page, in display order, so the caller can show it
+// before the last page arrives. Each partial extends the previous one.
+list_snapshot list_store_get(const list_key &key, uint64_t max_age_ns, const std::atomic<bool> *cancel,
+                             const list_progress_fn &on_partial = nullptr);
+
+// Returns what is already known for `key` without touching the network:
+// the in-memory snapshot, else the last good list saved on disk (which is
+// then kept as a stale snapshot, so the next list_store_get revalidates it).
+// Returns nullptr if there is neither.
+list_snapshot list_store_peek(const list_key &key);
+
+// Stores a list pushed by a backend (see companion-backend.hpp) as the
+// key's fresh snapshot. Sources pick it up on their next list_store_get.
+void list_store_publish(const list_key &key, list_snapshot snapshot);
+
+// Counts list_store_publish calls for `key`, so sources fed by pushes can
+// poll it cheaply to know when to look again.
+uint64_t list_store_publications(const list_key &key);
+
+// Snapshot with no entries, shared by every empty source.
+list_snapshot list_store_empty();
+
+list_store_stats list_store_get_stats();
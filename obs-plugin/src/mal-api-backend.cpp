@@ -0,0 +1,134 @@
+#include "mal-api-backend.hpp"
+#include "http-client.hpp"
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+#include <obs-module.h>
+
+static const char *MAL_API_HOST = "https://api.myanimelist.net";
+
+// Largest page the API serves, and the most pages past the first that are
+// requested at once (the rate limiter still paces them)
+static const size_t PAGE_SIZE = 1000;
+static const size_t PAGE_CONCURRENCY = 3;
+
+struct mal_api_page {
+    std::vector<MALEntry> entries;
+    bool has_next = false;
+    http_transfer_stats transfer; // when fetched on a helper thread
+};
+
+// MAL status name -> API status for the media
+static const char *api_status(const std::string &status, const std::string &media)
+{
+    bool manga = media == "manga";
+    if (status == "READING" || status == "WATCHING") return manga ? "reading" : "watching";
+    if (status == "COMPLETED") return "completed";
+    if (status == "PAUSED") return "on_hold";
+    if (status == "DROPPED") return "dropped";
+    if (status == "PLANNING") return manga ? "plan_to_read" : "plan_to_watch";
+    return nullptr;
+}
+
+// API status -> MAL status name
+static std::string mal_status(const std::string &status)
+{
+    if (status == "reading") return "READING";
+    if (status == "watching") return "WATCHING";
+    if (status == "completed") return "COMPLETED";
+    if (status == "on_hold") return "PAUSED";
+    if (status == "dropped") return "DROPPED";
+    if (status == "plan_to_read" || status == "plan_to_watch") return "PLANNING";
+    return status;
+}
+
+static mal_api_page fetch_page(const std::string &url, const std::string &client_id, const std::string &media,
+                               const std::atomic<bool> *cancel)
+{
+    http_request req;
+    req.url = url;
+    req.headers = {"X-MAL-CLIENT-ID: " + client_id, "Accept: application/json"};
+    req.cancel = cancel;
+    std::string body = http_fetch(req);
+
+    mal_api_page page;
+    const char *progress_key = media == "manga" ? "num_chapters_read" : "num_episodes_watched";
+    try {
+        auto json = nlohmann::json::parse(body);
+        for (const auto &item : json.at("data")) {
+            const auto &node = item.at("node");
+            const auto &list_status = item.at("list_status");
+
+            MALEntry entry;
+            entry.id = std::to_string(node.at("id").get<int>());
+            entry.title = node.value("title", "");
+            if (node.contains("main_picture")) {
+                const auto &pic = node["main_picture"];
+                // The loader derives the large variant when a card needs it
+                entry.coverImage = pic.value("medium", pic.value("large", ""));
+            }
+            entry.coverImage = MALFetcher::normalizeImageUrl(entry.coverImage);
+            entry.status = mal_status(list_status.value("status", ""));
+            entry.progress = list_status.value(progress_key, 0);
+            entry.media = media;
+            page.entries.push_back(entry);
+        }
+        page.has_next = json.contains("paging") && json["paging"].contains("next");
+    } catch (const std::exception &e) {
+        throw std::runtime_error(std::string("unexpected MAL API response: ") + e.what());
+    }
+    return page;
+}
+
+std::vector<MALEntry> MALApiBackend::fetchMedia(const std::string &username, const std::string &media,
+                                                const std::string &status, const std::atomic<bool> *cancel)
+{
+    if (client_id_.empty()) {
+        throw std::runtime_error("the MyAnimeList API needs a client ID");
+    }
+
+    std::string base = (host_.empty() ? MAL_API_HOST : host_) + "/v2/users/" + username + "/" + media + "list?fields=list_status&nsfw=true&limit=" +
+                       std::to_string(PAGE_SIZE);
+    if (const char *s = api_status(status, media)) base += std::string("&status=") + s;
+
+    blog(LOG_INFO, "Fetching MAL API %s list for %s (%s)", media.c_str(), username.c_str(), status.c_str());
+    mal_api_page first = fetch_page(base + "&offset=0", client_id_, media, cancel);
+    std::vector<MALEntry> entries = std::move(first.entries);
+
+    // Long lists: the API gives no total, only a link to the next page, so
+    // the following pages are requested one at a time at first and twice as
+    // many per batch (up to PAGE_CONCURRENCY) after every batch that was
+    // full. A list that ends early costs at most one request past its end.
+    bool more = first.has_next;
+    size_t offset = PAGE_SIZE;
+    size_t width = 1;
+    while (more) {
+        std::vector<std::future<mal_api_page>> batch;
+        for (size_t k = 0; k < width; k++) {
+            std::string url = base + "&offset=" + std::to_string(offset + k * PAGE_SIZE);
+            batch.push_back(std::async(std::launch::async, [this, url, media, cancel] {
+                const http_transfer_stats before = http_thread_stats();
+                mal_api_page page = fetch_page(url, client_id_, media, cancel);
+                page.transfer = http_thread_stats() - before;
+                return page;
+            }));
+        }
+        offset += width * PAGE_SIZE;
+        width = std::min(width * 2, PAGE_CONCURRENCY);
+
+        more = false;
+        bool done = false;
+        for (auto &f : batch) {
+            mal_api_page page = f.get();
+            http_thread_stats_add(page.transfer);
+            if (done) continue;
+            entries.insert(entries.end(), page.entries.begin(), page.entries.end());
+            more = page.has_next;
+            done = !page.has_next;
+        }
+    }
+
+    blog(LOG_INFO, "Fetched %zu entries", entries.size());
+    return entries;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "list-backend.hpp"
+
+// MyAnimeList's official REST API v2. Asks only for the fields a card
+// shows, every status of a media in one listing (paged by 1000), and needs
+// a client ID registered at myanimelist.net/apiconfig.
+class MALApiBackend : public ListBackend {
+public:
+    // `host` (optional) replaces https://api.myanimelist.net
+    explicit MALApiBackend(const std::string &client_id, const std::string &host = "")
+        : client_id_(client_id), host_(host) {}
+
+protected:
+    bool groupsStatuses() const override { return true; }
+
+    std::vector<MALEntry> fetchMedia(const std::string &username, const std::string &media,
+                                     const std::string &status, const std::atomic<bool> *cancel) override;
+
+private:
+    std::string client_id_;
+    std::string host_;
+};
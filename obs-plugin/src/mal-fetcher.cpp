@@ -1,14 +1,9 @@
 #include "mal-fetcher.hpp"
-#include <curl/curl.h>
+#include "http-client.hpp"
+#include <cstring>
 #include <map>
 #include <obs-module.h>
 
-static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
-{
-    ((std::string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
-}
-
 static void replace_all(std::string &str, const std::string &from, const std::string &to)
 {
     if (from.empty()) return;
@@ -19,50 +14,64 @@ static void replace_all(std::string &str, const std::string &from, const std::st
     }
 }
 
-MALFetcher::MALFetcher(const std::string &username) : username_(username) {}
+static const char *MAL_HOST = "https://myanimelist.net";
 
-std::string MALFetcher::fetchPage(const std::string &url)
-{
-    CURL *curl;
-    CURLcode res;
-    std::string readBuffer;
-    
-    curl = curl_easy_init();
-    if(curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36");
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-        
-        res = curl_easy_perform(curl);
-        if(res != CURLE_OK) {
-            blog(LOG_ERROR, "curl_easy_perform() failed: %s", curl_easy_strerror(res));
+MALFetcher::MALFetcher(const std::string &username, const std::atomic<bool> *cancel, const std::string &host)
+    : username_(username), cancel_(cancel), host_(host.empty() ? MAL_HOST : host) {}
+
+// Finds the data-items attribute in a page fed chunk by chunk (decompressed,
+// as curl hands them over), keeping only what may still be part of it
+struct data_items_scanner {
+    std::string window; // text not yet ruled out as the start of the attribute
+    std::string value;
+    char quote = 0;     // set once inside the attribute value
+    bool done = false;
+
+    // Returns false once the value is complete
+    bool feed(const char *data, size_t size)
+    {
+        static const std::string key = "data-items=";
+
+        if (!quote) {
+            window.append(data, size);
+            size_t pos = window.find(key);
+            if (pos == std::string::npos) {
+                // Keep enough to match a key split across chunks
+                if (window.size() > key.size()) window.erase(0, window.size() - key.size());
+                return true;
+            }
+
+            // find the first quote after the key
+            size_t quote_pos = window.find_first_of("\"'", pos + key.size());
+            if (quote_pos == std::string::npos) {
+                window.erase(0, pos);
+                return true;
+            }
+            quote = window[quote_pos];
+            std::string rest = window.substr(quote_pos + 1);
+            window.clear();
+            return feed(rest.data(), rest.size());
         }
-        curl_easy_cleanup(curl);
+
+        // find the matching closing quote
+        const char *end = (const char *)memchr(data, quote, size);
+        value.append(data, end ? (size_t)(end - data) : size);
+        done = end != nullptr;
+        return !done;
     }
-    
-    return readBuffer;
-}
+};
 
-std::string MALFetcher::extractDataItems(const std::string &html)
+std::string MALFetcher::fetchDataItems(const std::string &url)
 {
-    const std::string key = "data-items=";
-    size_t pos = html.find(key);
-    if (pos == std::string::npos) return "";
-
-    // find the first quote after the key
-    size_t quote_pos = html.find_first_of("\"'", pos + key.size());
-    if (quote_pos == std::string::npos) return "";
-    char quote = html[quote_pos];
-
-    // find the matching closing quote
-    size_t end_pos = html.find(quote, quote_pos + 1);
-    if (end_pos == std::string::npos || end_pos <= quote_pos + 1) return "";
+    http_request req;
+    req.url = url;
+    req.cancel = cancel_;
 
-    return html.substr(quote_pos + 1, end_pos - quote_pos - 1);
+    // The list table sits well before the end of the page; the transfer
+    // stops as soon as its attribute is complete
+    data_items_scanner scanner;
+    http_stream(req, 0, [&](const char *data, size_t size) { return scanner.feed(data, size); });
+    return scanner.done ? scanner.value : "";
 }
 
 std::string MALFetcher::normalizeImageUrl(const std::string &url)
@@ -71,15 +80,10 @@ std::string MALFetcher::normalizeImageUrl(const std::string &url)
         return "https://cdn.myanimelist.net/images/qm_50.gif";
     }
     
+    // Resized thumbnails (/r/96x136/...) are kept: they are signed for
+    // their size, and the cover loader picks the variant a card needs
+    // (cover_url_for_width)
     std::string normalized = url;
-
-    auto replace_once = [](std::string &s, const std::string &from, const std::string &to) {
-        size_t pos = s.find(from);
-        if (pos != std::string::npos) s.replace(pos, from.size(), to);
-    };
-
-    replace_once(normalized, "/r/96x136", "");
-    replace_once(normalized, "/r/50x70", "");
     
     // Add https if protocol-relative
     if (normalized.substr(0, 2) == "//") {
@@ -109,20 +113,15 @@ std::vector<MALEntry> MALFetcher::fetchList(const std::string &status, const std
     }
     
     std::string statusCode = statusMap.count(status) ? statusMap[status] : "7";
-    std::string url = "https://myanimelist.net/" + media + "list/" + username_ + "?status=" + statusCode;
+    std::string url = host_ + "/" + media + "list/" + username_ + "?status=" + statusCode;
     
     blog(LOG_INFO, "Fetching MAL list: %s", url.c_str());
     
-    std::string html = fetchPage(url);
-    if (html.empty()) {
-        blog(LOG_ERROR, "Failed to fetch page");
-        return entries;
-    }
-    
-    std::string dataItems = extractDataItems(html);
+    // An empty list still has data-items="[]"; a page without it (a login
+    // wall, a changed layout) must not replace the list with nothing
+    std::string dataItems = fetchDataItems(url);
     if (dataItems.empty()) {
-        blog(LOG_ERROR, "Could not find data-items in page");
-        return entries;
+        throw std::runtime_error("could not find data-items in " + url);
     }
     
     try {
@@ -156,7 +155,7 @@ std::vector<MALEntry> MALFetcher::fetchList(const std::string &status, const std
         blog(LOG_INFO, "Fetched %zu entries", entries.size());
         
     } catch (const std::exception &e) {
-        blog(LOG_ERROR, "Failed to parse JSON: %s", e.what());
+        throw std::runtime_error(std::string("could not parse data-items: ") + e.what());
     }
     
     return entries;
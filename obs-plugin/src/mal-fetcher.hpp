@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <memory>
@@ -16,15 +17,27 @@ struct MALEntry {
 
 class MALFetcher {
 public:
-    MALFetcher(const std::string &username);
+    // `cancel` (optional) aborts requests in flight, or waiting for the rate
+    // limiter, as soon as it is set; they then throw. `host` (optional)
+    // replaces https://myanimelist.net.
+    MALFetcher(const std::string &username, const std::atomic<bool> *cancel = nullptr,
+               const std::string &host = "");
     
+    // Throws std::runtime_error if the page could not be fetched (network
+    // error, non-2xx status, or requests to MAL paused by the rate limiter)
+    // or has no readable data-items; an empty list is returned as such
     std::vector<MALEntry> fetchList(const std::string &status, const std::string &media);
     
+    // Absolute cover URL; MAL's resize variants are left as they are
     static std::string normalizeImageUrl(const std::string &url);
     
 private:
     std::string username_;
+    const std::atomic<bool> *cancel_;
+    std::string host_;
     
-    std::string fetchPage(const std::string &url);
-    std::string extractDataItems(const std::string &html);
+    // Downloads a list page only as far as its data-items attribute and
+    // returns the attribute's (still HTML-escaped) value, or "" if the page
+    // has none
+    std::string fetchDataItems(const std::string &url);
 };
@@ -2,11 +2,17 @@
 #include <graphics/image-file.h>
 #include <graphics/graphics.h>
 #include <util/platform.h>
+#include <util/profiler.h>
 #include <util/threading.h>
 #include <algorithm>
 #include <cctype>
 #include <cstdint>
-#include "font5x7.hpp"
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include "text-cache.hpp"
+#include "http-client.hpp"
+#include <callback/proc.h>
 
 static const char *mal_source_get_name(void *unused)
 {
@@ -18,6 +24,19 @@ static void mal_source_update(void *data, obs_data_t *settings);
 static void mal_source_render(void *data, gs_effect_t *effect);
 static void mal_source_tick(void *data, float seconds);
 static void process_pending_gpu_frees(mal_source *ctx);
+static void evict_gpu_resources(mal_source *ctx);
+static void warm_up_visible(mal_source *ctx);
+
+// Scopes shown in OBS's profiler. It tells scopes apart by the name
+// pointer, so every scope uses one of these.
+static const char *PROFILE_TICK = "mal_source_tick";
+static const char *PROFILE_RENDER = "mal_source_render";
+static const char *PROFILE_FETCH = "mal_source_fetch";
+static const char *PROFILE_TEXT_LAYOUT = "mal_text_rasterize";
+static const char *PROFILE_CULL = "mal_cull";
+static const char *PROFILE_UPLOADS = "mal_uploads";
+static const char *PROFILE_UPLOAD_TEXT = "mal_upload_text";
+static const char *PROFILE_UPLOAD_COVER = "mal_upload_cover";
 
 static inline uint32_t pack_rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
@@ -90,102 +109,301 @@ static uint32_t status_color_rgba(const std::string &status)
     return pack_rgba(0xFF, 0xFF, 0xFF, 0xFF); // default white
 }
 
-static void fetch_entries_async(mal_source *ctx)
+struct text_params {
+    uint32_t title_color;
+    bool status_use_color;
+    uint32_t status_color;
+    bool show_media;
+    uint64_t generation; // mal_source::text_generation these were read at
+};
+
+static text_params get_text_params(const mal_source *ctx)
 {
-    ctx->fetching = true;
+    text_params p;
+    p.title_color = ctx->title_color;
+    p.status_use_color = ctx->status_use_color != 0;
+    p.status_color = ctx->status_color;
+    p.show_media = ctx->show_media_tag && (ctx->media == "both");
+    p.generation = ctx->text_generation;
+    return p;
+}
 
-    try {
-        std::vector<MALEntry> entries;
-        
-        // If status is "ALL", fetch all status categories separately to get status info per entry
-        if (ctx->status == "ALL") {
-            std::vector<std::string> statuses = {"WATCHING", "COMPLETED", "PAUSED", "DROPPED", "PLANNING"};
-            
-            if (ctx->media == "both") {
-                for (const auto &status : statuses) {
-                    MALFetcher mangaFetcher(ctx->username);
-                    MALFetcher animeFetcher(ctx->username);
-                    auto m = mangaFetcher.fetchList(status == "WATCHING" ? "READING" : status, "manga");
-                    auto a = animeFetcher.fetchList(status, "anime");
-                    entries.insert(entries.end(), m.begin(), m.end());
-                    entries.insert(entries.end(), a.begin(), a.end());
-                }
-            } else {
-                for (const auto &status : statuses) {
-                    auto status_to_fetch = status;
-                    if (ctx->media == "manga" && status == "WATCHING") status_to_fetch = "READING";
-                    if (ctx->media == "anime" && status == "READING") status_to_fetch = "WATCHING";
-                    
-                    MALFetcher fetcher(ctx->username);
-                    auto list = fetcher.fetchList(status_to_fetch, ctx->media);
-                    entries.insert(entries.end(), list.begin(), list.end());
-                }
-            }
-        } else if (ctx->media == "both") {
-            MALFetcher mangaFetcher(ctx->username);
-            MALFetcher animeFetcher(ctx->username);
-            auto m = mangaFetcher.fetchList(ctx->status == "WATCHING" ? "READING" : ctx->status, "manga");
-            auto a = animeFetcher.fetchList(ctx->status == "READING" ? "WATCHING" : ctx->status, "anime");
-            entries.reserve(m.size() + a.size());
-            entries.insert(entries.end(), m.begin(), m.end());
-            entries.insert(entries.end(), a.begin(), a.end());
+// Specialized on the badge flags so laying out a large list never
+// re-checks them per entry
+template <bool StatusUseColor, bool ShowMedia>
+static mal_source::EntryLayout build_entry_layout(const MALEntry &entry, const text_params &p)
+{
+    mal_source::EntryLayout layout;
+
+    auto title_lines = wrap_lines(truncate_text(entry.title, 100), 20, 4);
+    for (size_t i = 0; i < title_lines.size() && i < 4; i++) {
+        layout.title[i].text = title_lines[i];
+        layout.title[i].rgba = p.title_color;
+        text_run_rasterize(layout.title[i]);
+    }
+
+    // Build status badge text
+    std::string status_text = entry.status;
+
+    // Convert READING<->WATCHING based on media type
+    if (status_text == "READING" && entry.media == "anime") {
+        status_text = "WATCHING";
+    } else if (status_text == "WATCHING" && entry.media == "manga") {
+        status_text = "READING";
+    }
+
+    // If both media types are shown, include the medium in the badge text only if enabled
+    if (!status_text.empty()) {
+        if (ShowMedia) {
+            layout.status.text = (entry.media == "anime" ? "ANIME " : "MANGA ") + status_text;
+        } else {
+            layout.status.text = status_text;
+        }
+        layout.status.rgba = StatusUseColor ? status_color_rgba(entry.status) : p.status_color;
+        text_run_rasterize(layout.status);
+    }
+
+    return layout;
+}
+
+// Entries with reuse[i] >= 0 keep the layout they already have and are
+// left empty here; an empty `reuse` lays out everything
+template <bool StatusUseColor, bool ShowMedia>
+static std::vector<mal_source::EntryLayout> build_layouts_for(const std::vector<MALEntry> &entries, const text_params &p,
+                                                              const std::vector<int> &reuse)
+{
+    std::vector<mal_source::EntryLayout> layouts(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i < reuse.size() && reuse[i] >= 0) continue;
+        layouts[i] = build_entry_layout<StatusUseColor, ShowMedia>(entries[i], p);
+    }
+    return layouts;
+}
+
+static std::vector<mal_source::EntryLayout> build_layouts(const std::vector<MALEntry> &entries, const text_params &p,
+                                                          const std::vector<int> &reuse = std::vector<int>())
+{
+    // Runs on fetch threads and the UI thread, each its own profiler root
+    profile_start(PROFILE_TEXT_LAYOUT);
+    std::vector<mal_source::EntryLayout> layouts;
+    if (p.status_use_color) {
+        layouts = p.show_media ? build_layouts_for<true, true>(entries, p, reuse)
+                               : build_layouts_for<true, false>(entries, p, reuse);
+    } else {
+        layouts = p.show_media ? build_layouts_for<false, true>(entries, p, reuse)
+                               : build_layouts_for<false, false>(entries, p, reuse);
+    }
+    profile_end(PROFILE_TEXT_LAYOUT);
+    return layouts;
+}
+
+// For each new entry, the index of the same unchanged entry in the old list
+// (matched by media and id), or -1 if it has to be built from scratch
+static std::vector<int> match_entries(const std::vector<MALEntry> &old_entries, const std::vector<MALEntry> &entries)
+{
+    std::unordered_map<std::string, int> old_index;
+    old_index.reserve(old_entries.size());
+    for (size_t i = 0; i < old_entries.size(); i++) {
+        old_index.emplace(old_entries[i].media + '/' + old_entries[i].id, (int)i);
+    }
+
+    std::vector<int> reuse(entries.size(), -1);
+    for (size_t i = 0; i < entries.size(); i++) {
+        auto it = old_index.find(entries[i].media + '/' + entries[i].id);
+        if (it == old_index.end() || it->second < 0) continue;
+        const MALEntry &old = old_entries[it->second];
+        if (old.title == entries[i].title && old.status == entries[i].status &&
+            old.coverImage == entries[i].coverImage) {
+            reuse[i] = it->second;
+            it->second = -1; // each old entry is handed out once
+        }
+    }
+    return reuse;
+}
+
+// Caller holds data_mutex; textures are handed back on the render thread
+static void release_text_textures(mal_source *ctx, mal_source::LoadedImage &img)
+{
+    for (int i = 0; i < 4; i++) {
+        if (img.title_tex[i]) {
+            ctx->pending_textures_free.push_back(img.title_tex[i]);
+            img.title_tex[i] = nullptr;
+        }
+    }
+    if (img.status_tex) {
+        ctx->pending_textures_free.push_back(img.status_tex);
+        img.status_tex = nullptr;
+    }
+    img.ops_valid = false;
+}
+
+// Caller holds data_mutex; the render target goes back to the pool
+static void release_card(mal_source *ctx, mal_source::LoadedImage &img)
+{
+    if (img.card.render) {
+        ctx->card_pool.push_back(img.card.render);
+        img.card.render = nullptr;
+    }
+    img.card_valid = false;
+}
+
+// Width of one pre-rendered strip tile; a 1920px view spans at most three
+static const uint32_t STRIP_TILE_WIDTH = 2048;
+// Backgrounds may overhang a card by up to the padding
+static const float STRIP_CARD_MARGIN = 32.0f;
+
+// Caller holds data_mutex
+static void release_strip_tiles(mal_source *ctx)
+{
+    for (auto &tile : ctx->strip_tiles) {
+        if (tile.render) ctx->card_pool.push_back(tile.render);
+        tile.render = nullptr;
+        tile.valid = false;
+    }
+    ctx->resident_tiles.clear();
+}
+
+// The companion server scrapes its own configured user; every other
+// backend needs a username of at least 3 characters before fetching
+static bool has_query(const std::string &backend, const std::string &username)
+{
+    return backend == "companion" || username.length() >= 3;
+}
+
+static list_key list_key_for(const mal_source *ctx)
+{
+    list_key key;
+    key.backend = ctx->backend;
+    key.client_id = ctx->client_id;
+    if (ctx->backend == "companion") {
+        key.endpoint = ctx->endpoint;
+        while (!key.endpoint.empty() && key.endpoint.back() == '/') key.endpoint.pop_back();
+    }
+    key.username = ctx->username;
+    key.media = ctx->media;
+    key.status = ctx->status;
+    if (ctx->status == "ALL") key.first_status = ctx->first_status;
+    return key;
+}
+
+// Caller holds data_mutex. Entries matched in `reuse` (see match_entries)
+// take over their layout, cover, text textures and card from the current
+// list; everything else built for the current list is let go.
+static void set_entries(mal_source *ctx, list_snapshot entries, std::vector<mal_source::EntryLayout> layouts,
+                        const std::vector<int> &reuse)
+{
+    std::vector<mal_source::LoadedImage> images(entries->size());
+    std::vector<int> new_index(ctx->images.size(), -1);
+    for (size_t i = 0; i < images.size(); i++) {
+        int from = i < reuse.size() ? reuse[i] : -1;
+        if (from >= 0 && (size_t)from < ctx->images.size() && (size_t)from < ctx->layouts.size()) {
+            images[i] = std::move(ctx->images[from]);
+            layouts[i] = std::move(ctx->layouts[from]);
+            new_index[from] = (int)i;
         } else {
-            entries = ctx->fetcher->fetchList(ctx->status, ctx->media);
+            images[i].url = (*entries)[i].coverImage;
+        }
+    }
+
+    for (size_t j = 0; j < ctx->images.size(); j++) {
+        if (new_index[j] >= 0) continue;
+        auto &img = ctx->images[j];
+        if (img.image) {
+            ctx->pending_images_free.push_back(img.image);
+            img.image = nullptr;
         }
+        release_text_textures(ctx, img);
+        release_card(ctx, img);
+    }
+
+    std::vector<size_t> resident;
+    for (size_t j : ctx->resident_cards) {
+        if (j < new_index.size() && new_index[j] >= 0) resident.push_back((size_t)new_index[j]);
+    }
+    ctx->resident_cards.swap(resident);
+
+    // Strip tiles bake in positions, which moved
+    release_strip_tiles(ctx);
+    ctx->strip_tiles.clear();
+
+    ctx->entries = std::move(entries);
+    ctx->layouts = std::move(layouts);
+    ctx->images = std::move(images);
+}
+
+// Shows `entries` (a full list or the pages fetched so far), laying out only
+// entries the current list does not already have. Returns false if the
+// query or the text settings changed since the fetch started.
+static bool publish_entries(mal_source *ctx, const list_snapshot &entries, const text_params &p, uint64_t generation)
+{
+    for (;;) {
+        list_snapshot current;
+        {
+            std::lock_guard<std::mutex> lock(ctx->data_mutex);
+            if (ctx->cancel_fetch) return false;
+            if (generation != ctx->fetch_generation || ctx->text_generation != p.generation) return false;
+            if (entries == ctx->entries) return true;
+            current = ctx->entries;
+        }
+
+        // Lay out and rasterize new text here so the render thread only uploads
+        uint64_t parse_start = os_gettime_ns();
+        std::vector<int> reuse = match_entries(*current, *entries);
+        auto layouts = build_layouts(*entries, p, reuse);
+        stats_histogram_record(ctx->stats.parse_time, os_gettime_ns() - parse_start);
 
         std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        if (ctx->cancel_fetch) return false;
+        if (generation != ctx->fetch_generation || ctx->text_generation != p.generation) return false;
+        // Otherwise another list was shown meanwhile; match against that one
+        if (current == ctx->entries) {
+            set_entries(ctx, entries, std::move(layouts), reuse);
+            return true;
+        }
+    }
+}
 
-        ctx->entries = std::move(entries);
-        blog(LOG_INFO, "[MAL] ===== Loaded %zu entries from fetcher =====", ctx->entries.size());
-        if (!ctx->entries.empty()) {
-            blog(LOG_INFO, "[MAL] First entry: '%s' (status=%s, media=%s)",
-                 ctx->entries[0].title.c_str(), ctx->entries[0].status.c_str(), ctx->entries[0].media.c_str());
+static void fetch_entries_async(mal_source *ctx, list_key key, text_params p, uint64_t generation)
+{
+    try {
+        uint64_t max_age_ns;
+        {
+            std::lock_guard<std::mutex> lock(ctx->data_mutex);
+            max_age_ns = (uint64_t)ctx->refresh_interval * 1000000000ULL;
         }
 
-        for (auto &img : ctx->images) {
-            if (img.image) {
-                ctx->pending_images_free.push_back(img.image);
-                img.image = nullptr;
-            }
-            if (img.title_tex) {
-                ctx->pending_textures_free.push_back(img.title_tex);
-                img.title_tex = nullptr;
-            }
-            if (img.title2_tex) {
-                ctx->pending_textures_free.push_back(img.title2_tex);
-                img.title2_tex = nullptr;
-            }
-            if (img.title3_tex) {
-                ctx->pending_textures_free.push_back(img.title3_tex);
-                img.title3_tex = nullptr;
-            }
-            if (img.title4_tex) {
-                ctx->pending_textures_free.push_back(img.title4_tex);
-                img.title4_tex = nullptr;
-            }
-            if (img.status_tex) {
-                ctx->pending_textures_free.push_back(img.status_tex);
-                img.status_tex = nullptr;
-            }
+        // On a first load each page shows up as soon as it is fetched
+        auto on_partial = [&](const list_snapshot &partial) {
+            publish_entries(ctx, partial, p, generation);
+        };
+        uint64_t fetch_start = os_gettime_ns();
+        const http_transfer_stats before = http_thread_stats();
+        list_snapshot entries = list_store_get(key, max_age_ns, &ctx->cancel_fetch, on_partial);
+        const http_transfer_stats transfer = http_thread_stats() - before;
+        ctx->stats.bytes_received += transfer.received;
+        ctx->stats.bytes_decoded += transfer.decoded;
+        if (!entries || ctx->cancel_fetch) {
+            ctx->fetching = false;
+            return;
+        }
+        ctx->stats.fetches++;
+        ctx->stats.entries = entries->size();
+        stats_histogram_record(ctx->stats.fetch_latency, os_gettime_ns() - fetch_start);
+
+        if (!publish_entries(ctx, entries, p, generation)) {
+            // The query or the text settings changed while this was in flight
+            blog(LOG_DEBUG, "[MAL] Dropping stale list for '%s'", key.username.c_str());
+            if (ctx->refetch_at == 0) ctx->refetch_at = os_gettime_ns();
+            ctx->fetching = false;
+            return;
         }
-        ctx->images.clear();
-
-        for (const auto &entry : ctx->entries) {
-            mal_source::LoadedImage loaded;
-            loaded.url = entry.coverImage;
-            loaded.image = nullptr;
-            loaded.loaded = false;
-            loaded.title_tex = nullptr;
-            loaded.title_w = loaded.title_h = 0;
-            loaded.title2_tex = nullptr;
-            loaded.title2_w = loaded.title2_h = 0;
-            loaded.title3_tex = nullptr;
-            loaded.title3_w = loaded.title3_h = 0;
-            loaded.title4_tex = nullptr;
-            loaded.title4_w = loaded.title4_h = 0;
-            loaded.status_tex = nullptr;
-            loaded.status_w = loaded.status_h = 0;
-            ctx->images.push_back(loaded);
+
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        blog(LOG_INFO, "[MAL] ===== Loaded %zu entries from fetcher =====", ctx->entries->size());
+        if (!ctx->entries->empty()) {
+            const auto &first = ctx->entries->front();
+            blog(LOG_INFO, "[MAL] First entry: '%s' (status=%s, media=%s)",
+                 first.title.c_str(), first.status.c_str(), first.media.c_str());
         }
 
     } catch (const std::exception &e) {
@@ -196,6 +414,43 @@ static void fetch_entries_async(mal_source *ctx)
     ctx->last_fetch_time = os_gettime_ns();
 }
 
+// Fetch threads still running, waited for on module unload
+static std::atomic<int> g_fetch_threads(0);
+
+// The source is shared by OBS and its fetch thread; whoever lets go last frees it
+static void mal_source_unref(mal_source *ctx)
+{
+    if (ctx->refs.fetch_sub(1) == 1) delete ctx;
+}
+
+static void fetch_thread_main(mal_source *ctx, list_key key, text_params p, uint64_t generation)
+{
+    profile_start(PROFILE_FETCH);
+    fetch_entries_async(ctx, std::move(key), p, generation);
+    profile_end(PROFILE_FETCH);
+    mal_source_unref(ctx);
+    g_fetch_threads--;
+}
+
+void mal_source_wait_for_fetches()
+{
+    // Sources are gone and their fetches cancelled; curl notices within a second
+    for (int i = 0; i < 200 && g_fetch_threads > 0; i++) {
+        os_sleep_ms(10);
+    }
+    if (g_fetch_threads > 0) {
+        blog(LOG_WARNING, "[MAL] %d list fetches still running at unload", (int)g_fetch_threads);
+    }
+}
+
+// Proc handler "get_stats": the source's statistics as a JSON string, for
+// scripts and other plugins (proc_handler_call on the source)
+static void mal_source_proc_get_stats(void *data, calldata_t *cd)
+{
+    mal_source *ctx = (mal_source *)data;
+    calldata_set_string(cd, "json", source_stats_json(ctx->stats).c_str());
+}
+
 static void *mal_source_create(obs_data_t *settings, obs_source_t *source)
 {
     blog(LOG_INFO, "[MAL] mal_source_create called");
@@ -204,12 +459,45 @@ static void *mal_source_create(obs_data_t *settings, obs_source_t *source)
     ctx->scroll_offset = 0.0f;
     ctx->last_update_time = os_gettime_ns();
     ctx->fetching = false;
+    ctx->cancel_fetch = false;
+    ctx->refs = 1;
+    ctx->entries = list_store_empty();
     ctx->last_fetch_time = 0;
+    ctx->seen_publications = 0;
+    ctx->refetch_at = 0;
+    ctx->relayout_at = 0;
+    ctx->fetch_generation = 0;
+    ctx->text_generation = 0;
     ctx->refresh_interval = 300; // 5 minutes
     ctx->text_scale = 1.0f;
     ctx->white_texture = nullptr;
+    ctx->render_time_ns = 0;
+    ctx->render_time_max_ns = 0;
+    ctx->render_frames = 0;
+    ctx->render_state_changes = 0;
+    ctx->last_timing_log = os_gettime_ns();
+    ctx->last_residency_sample = 0;
+    ctx->showing = false;
+    ctx->hidden_since = os_gettime_ns();
+    ctx->gpu_evicted = false;
+    ctx->warm_up_pending = false;
 
     mal_source_update(ctx, settings);
+    ctx->cover_px = ctx->item_width;
+
+    // Show the last good list right away; the debounced fetch scheduled by
+    // the update above revalidates it
+    if (has_query(ctx->backend, ctx->username)) {
+        list_snapshot saved = list_store_peek(list_key_for(ctx));
+        if (saved) {
+            auto layouts = build_layouts(*saved, get_text_params(ctx));
+            std::lock_guard<std::mutex> lock(ctx->data_mutex);
+            set_entries(ctx, std::move(saved), std::move(layouts), std::vector<int>());
+        }
+    }
+
+    proc_handler_t *ph = obs_source_get_proc_handler(source);
+    proc_handler_add(ph, "void get_stats(out string json)", mal_source_proc_get_stats, ctx);
 
     return ctx;
 }
@@ -218,15 +506,23 @@ static void mal_source_destroy(void *data)
 {
     mal_source *ctx = (mal_source *)data;
 
+    // Abort the fetch (or the wait on another source's fetch) without
+    // waiting for it: the thread drops its reference once curl returns,
+    // and no longer touches the list once this is set
+    {
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        ctx->cancel_fetch = true;
+        companion_unsubscribe(ctx->companion);
+    }
     if (ctx->fetch_thread.joinable()) {
-        ctx->fetch_thread.join();
+        ctx->fetch_thread.detach();
     }
 
     process_pending_gpu_frees(ctx);
     
     if (ctx->white_texture) {
         obs_enter_graphics();
-        gs_texture_destroy(ctx->white_texture);
+        text_cache_release(ctx->white_texture);
         obs_leave_graphics();
     }
 
@@ -237,67 +533,34 @@ static void mal_source_destroy(void *data)
             obs_leave_graphics();
             delete img.image;
         }
-        if (img.title_tex || img.status_tex) {
-            obs_enter_graphics();
-            if (img.title_tex) {
-                gs_texture_destroy(img.title_tex);
-            }
-            if (img.title2_tex) {
-                gs_texture_destroy(img.title2_tex);
-            }
-            if (img.title3_tex) {
-                gs_texture_destroy(img.title3_tex);
-            }
-            if (img.title4_tex) {
-                gs_texture_destroy(img.title4_tex);
-            }
-            if (img.status_tex) {
-                gs_texture_destroy(img.status_tex);
-            }
-            obs_leave_graphics();
+        obs_enter_graphics();
+        for (int i = 0; i < 4; i++) {
+            text_cache_release(img.title_tex[i]);
         }
+        text_cache_release(img.status_tex);
+        gs_texrender_destroy(img.card.render);
+        obs_leave_graphics();
     }
 
-    delete ctx;
-}
-
-static void load_image_if_needed(mal_source *ctx, size_t index)
-{
-    if (index >= ctx->images.size()) return;
-
-    auto &img = ctx->images[index];
-    if (img.loaded || img.url.empty()) return;
-
-    img.image = new gs_image_file_t();
-    gs_image_file_init(img.image, img.url.c_str());
-
     obs_enter_graphics();
-    gs_image_file_init_texture(img.image);
+    for (auto &tile : ctx->strip_tiles) {
+        gs_texrender_destroy(tile.render);
+    }
+    for (auto *render : ctx->card_pool) {
+        gs_texrender_destroy(render);
+    }
     obs_leave_graphics();
 
-    if (img.image->texture) {
-        img.loaded = true;
-        blog(LOG_DEBUG, "Loaded image: %s", img.url.c_str());
-    } else {
-        blog(LOG_WARNING, "Failed to load image: %s", img.url.c_str());
-        gs_image_file_free(img.image);
-        delete img.image;
-        img.image = nullptr;
-    }
+    mal_source_unref(ctx);
 }
 
-static gs_texture_t *make_text_texture(const std::string &text, uint32_t rgba, uint32_t &w, uint32_t &h)
-{
-    std::vector<uint8_t> pixels;
-    font5x7_render(text, rgba, pixels, w, h);
-    if (pixels.empty() || w == 0 || h == 0) return nullptr;
-    const uint8_t *level_data[1] = { pixels.data() };
-    return gs_texture_create(w, h, GS_RGBA, 1, level_data, GS_DYNAMIC);
-}
+// Spare card render targets kept around for reuse
+static const size_t MAX_CARD_POOL = 16;
 
 static void process_pending_gpu_frees(mal_source *ctx)
 {
-    if (ctx->pending_images_free.empty() && ctx->pending_textures_free.empty()) return;
+    if (ctx->pending_images_free.empty() && ctx->pending_textures_free.empty() &&
+        ctx->card_pool.size() <= MAX_CARD_POOL) return;
 
     obs_enter_graphics();
     for (auto *img : ctx->pending_images_free) {
@@ -307,9 +570,11 @@ static void process_pending_gpu_frees(mal_source *ctx)
         }
     }
     for (auto *tex : ctx->pending_textures_free) {
-        if (tex) {
-            gs_texture_destroy(tex);
-        }
+        text_cache_release(tex);
+    }
+    while (ctx->card_pool.size() > MAX_CARD_POOL) {
+        gs_texrender_destroy(ctx->card_pool.back());
+        ctx->card_pool.pop_back();
     }
     obs_leave_graphics();
 
@@ -317,425 +582,835 @@ static void process_pending_gpu_frees(mal_source *ctx)
     ctx->pending_textures_free.clear();
 }
 
-static void ensure_textures_for_entry(mal_source *ctx, size_t index)
+// Uploads the text of an entry, as far as `budget` (if any) allows
+static void ensure_textures_for_entry(mal_source *ctx, size_t index, upload_budget *budget = nullptr)
 {
-    if (index >= ctx->entries.size() || index >= ctx->images.size()) return;
+    if (index >= ctx->layouts.size() || index >= ctx->images.size()) return;
 
     auto &img = ctx->images[index];
-    const auto &entry = ctx->entries[index];
+    auto &layout = ctx->layouts[index];
+
+    auto acquire = [&](text_run &run, gs_texture_t *&tex, uint32_t &w, uint32_t &h) {
+        if (tex || run.text.empty()) return true;
+        if (budget && !upload_budget_allows(*budget, upload_kind::text)) return false;
+        uint64_t start = os_gettime_ns();
+        profile_start(PROFILE_UPLOAD_TEXT);
+        tex = text_cache_acquire(run, w, h);
+        profile_end(PROFILE_UPLOAD_TEXT);
+        if (budget) upload_budget_spend(*budget, upload_kind::text, os_gettime_ns() - start);
+        img.ops_valid = false;
+        return true;
+    };
+
+    // Text was laid out and rasterized off-thread; this only uploads
+    for (int i = 0; i < 4; i++) {
+        if (!acquire(layout.title[i], img.title_tex[i], img.title_w[i], img.title_h[i])) return;
+    }
+    acquire(layout.status, img.status_tex, img.status_w, img.status_h);
+}
 
-    // Check if we need to create any textures
-    bool need_title = !img.title_tex;
-    bool need_status = !img.status_tex;
-    
-    if (!need_title && !need_status) return;
+static void update_layout_params(mal_source *ctx)
+{
+    card_layout_params &p = ctx->layout;
+    p.item_width = (float)ctx->item_width;
+    p.pitch = (float)(ctx->item_width + ctx->item_gap);
+    p.text_scale = ctx->text_scale;
+    p.text_background = ctx->text_background;
+    p.background_padding = ctx->background_padding;
+
+    uint32_t c = ctx->background_color;
+    p.background_color.x = (float)((c >> 0) & 0xFF) / 255.0f;  // R
+    p.background_color.y = (float)((c >> 8) & 0xFF) / 255.0f;  // G
+    p.background_color.z = (float)((c >> 16) & 0xFF) / 255.0f; // B
+    p.background_color.w = ctx->background_opacity;             // Alpha from slider
+
+    card_layout_specialize(p);
+}
 
-    auto title_lines = wrap_lines(truncate_text(entry.title, 100), 20, 4);
-    std::string title_text = title_lines.size() > 0 ? title_lines[0] : "";
-    std::string title_text2 = title_lines.size() > 1 ? title_lines[1] : "";
-    std::string title_text3 = title_lines.size() > 2 ? title_lines[2] : "";
-    std::string title_text4 = title_lines.size() > 3 ? title_lines[3] : "";
-    
-    // Build status badge text
-    std::string status_text = entry.status.empty() ? "" : entry.status;
-    
-    // Convert READING<->WATCHING based on media type
-    if (status_text == "READING" && entry.media == "anime") {
-        status_text = "WATCHING";
-    } else if (status_text == "WATCHING" && entry.media == "manga") {
-        status_text = "READING";
-    }
-    
-    std::string base_status = entry.status;
-    
-    // If both media types are shown, include the medium in the badge text only if enabled
-    bool show_media = ctx->show_media_tag && (ctx->media == "both");
-    std::string media_tag = entry.media == "anime" ? "ANIME" : "MANGA";
-    std::string status_label = "";
-    
-    if (!status_text.empty()) {
-        status_label = show_media ? media_tag + " " + status_text : status_text;
-    }
+// Edits that land within this window are folded into one refetch or relayout
+static const uint64_t REFETCH_DEBOUNCE_NS = 750000000ULL;
 
-    uint32_t title_w = 0, title_h = 0;
-    uint32_t status_w = 0, status_h = 0;
-    
-    if (!img.title_tex) {
-        gs_texture_t *title_tex = make_text_texture(title_text, ctx->title_color, title_w, title_h);
-        if (title_tex) {
-            img.title_tex = title_tex;
-            img.title_w = title_w;
-            img.title_h = title_h;
-        }
-    }
-    if (!img.title2_tex && !title_text2.empty()) {
-        gs_texture_t *title_tex2 = make_text_texture(title_text2, ctx->title_color, title_w, title_h);
-        if (title_tex2) {
-            img.title2_tex = title_tex2;
-            img.title2_w = title_w;
-            img.title2_h = title_h;
-        }
-    }
-    if (!img.title3_tex && !title_text3.empty()) {
-        gs_texture_t *title_tex3 = make_text_texture(title_text3, ctx->title_color, title_w, title_h);
-        if (title_tex3) {
-            img.title3_tex = title_tex3;
-            img.title3_w = title_w;
-            img.title3_h = title_h;
-        }
-    }
-    if (!img.title4_tex && !title_text4.empty()) {
-        gs_texture_t *title_tex4 = make_text_texture(title_text4, ctx->title_color, title_w, title_h);
-        if (title_tex4) {
-            img.title4_tex = title_tex4;
-            img.title4_w = title_w;
-            img.title4_h = title_h;
-        }
+// Re-wraps and re-rasterizes every entry's text for new text settings, on
+// the fetch thread. The result is dropped if the list or the text settings
+// changed meanwhile: a newer edit schedules its own relayout, and a list
+// shown meanwhile was laid out with the current settings.
+static void relayout_text(mal_source *ctx, const list_snapshot &entries, const text_params &p)
+{
+    auto layouts = build_layouts(*entries, p);
+
+    std::lock_guard<std::mutex> lock(ctx->data_mutex);
+    if (ctx->cancel_fetch || entries != ctx->entries || p.generation != ctx->text_generation) return;
+    ctx->layouts = std::move(layouts);
+    for (auto &img : ctx->images) {
+        release_text_textures(ctx, img);
     }
-    if (!img.status_tex && !status_label.empty()) {
-        uint32_t status_col = ctx->status_use_color ? status_color_rgba(base_status) : ctx->status_color;
-        gs_texture_t *status_tex = make_text_texture(status_label, status_col, status_w, status_h);
-        if (status_tex) {
-            img.status_tex = status_tex;
-            img.status_w = status_w;
-            img.status_h = status_h;
-        }
+    for (auto &tile : ctx->strip_tiles) {
+        tile.valid = false;
     }
 }
 
+static void relayout_thread_main(mal_source *ctx, list_snapshot entries, text_params p)
+{
+    relayout_text(ctx, entries, p);
+    ctx->fetching = false;
+    mal_source_unref(ctx);
+    g_fetch_threads--;
+}
+
 static void mal_source_update(void *data, obs_data_t *settings)
 {
     mal_source *ctx = (mal_source *)data;
 
-    ctx->username = obs_data_get_string(settings, "username");
-    ctx->status = obs_data_get_string(settings, "status");
-    ctx->media = obs_data_get_string(settings, "media");
-    ctx->scroll_speed = (int)obs_data_get_int(settings, "scroll_speed");
-    ctx->item_width = (int)obs_data_get_int(settings, "item_width");
-    ctx->item_gap = (int)obs_data_get_int(settings, "item_gap");
-    ctx->refresh_interval = (int)obs_data_get_int(settings, "refresh_interval");
-    ctx->text_scale = (float)obs_data_get_double(settings, "text_scale");
-    if (ctx->text_scale <= 0.0f) ctx->text_scale = 1.0f;
-    
-    // Text colors
-    ctx->title_color = (uint32_t)obs_data_get_int(settings, "title_color");
-    ctx->status_use_color = obs_data_get_bool(settings, "status_use_color");
-    ctx->status_color = (uint32_t)obs_data_get_int(settings, "status_color");
-    ctx->show_media_tag = obs_data_get_bool(settings, "show_media_tag");
-    ctx->text_background = obs_data_get_bool(settings, "text_background");
-    ctx->background_color = (uint32_t)obs_data_get_int(settings, "background_color");
-    ctx->background_padding = (float)obs_data_get_double(settings, "background_padding");
-    ctx->background_opacity = (float)obs_data_get_double(settings, "background_opacity");
-    if (ctx->background_opacity < 0.0f) ctx->background_opacity = 0.0f;
-    if (ctx->background_opacity > 1.0f) ctx->background_opacity = 1.0f;
-
-    // Clear all text textures to force recreation with new settings
-    std::lock_guard<std::mutex> lock(ctx->data_mutex);
-    for (auto &img : ctx->images) {
-        if (img.title_tex) {
-            ctx->pending_textures_free.push_back(img.title_tex);
-            img.title_tex = nullptr;
-        }
-        if (img.title2_tex) {
-            ctx->pending_textures_free.push_back(img.title2_tex);
-            img.title2_tex = nullptr;
-        }
-        if (img.title3_tex) {
-            ctx->pending_textures_free.push_back(img.title3_tex);
-            img.title3_tex = nullptr;
+    std::string backend = obs_data_get_string(settings, "backend");
+    std::string username = obs_data_get_string(settings, "username");
+    std::string client_id = obs_data_get_string(settings, "client_id");
+    std::string endpoint = obs_data_get_string(settings, "endpoint");
+    std::string status = obs_data_get_string(settings, "status");
+    std::string media = obs_data_get_string(settings, "media");
+    std::string first_status = obs_data_get_string(settings, "first_status");
+    bool query_changed = backend != ctx->backend || username != ctx->username || status != ctx->status ||
+                         media != ctx->media || (backend == "mal_api" && client_id != ctx->client_id) ||
+                         (backend == "companion" && endpoint != ctx->endpoint) ||
+                         (status == "ALL" && first_status != ctx->first_status);
+
+    // Plain values: read every frame, nothing to rebuild
+    int scroll_speed = (int)obs_data_get_int(settings, "scroll_speed");
+    int refresh_interval = (int)obs_data_get_int(settings, "refresh_interval");
+    int evict_after = (int)obs_data_get_int(settings, "evict_after");
+    std::string render_mode = obs_data_get_string(settings, "render_mode");
+    bool cover_webp = strcmp(obs_data_get_string(settings, "cover_format"), "webp") == 0;
+
+    // Card geometry
+    int item_width = (int)obs_data_get_int(settings, "item_width");
+    int item_gap = (int)obs_data_get_int(settings, "item_gap");
+    float text_scale = (float)obs_data_get_double(settings, "text_scale");
+    if (text_scale <= 0.0f) text_scale = 1.0f;
+    bool text_background = obs_data_get_bool(settings, "text_background");
+    uint32_t background_color = (uint32_t)obs_data_get_int(settings, "background_color");
+    float background_padding = (float)obs_data_get_double(settings, "background_padding");
+    float background_opacity = (float)obs_data_get_double(settings, "background_opacity");
+    if (background_opacity < 0.0f) background_opacity = 0.0f;
+    if (background_opacity > 1.0f) background_opacity = 1.0f;
+    bool geometry_changed = item_width != ctx->item_width || item_gap != ctx->item_gap ||
+                            text_scale != ctx->text_scale || text_background != ctx->text_background ||
+                            background_color != ctx->background_color ||
+                            background_padding != ctx->background_padding ||
+                            background_opacity != ctx->background_opacity;
+
+    // Text colors and badge content
+    uint32_t title_color = (uint32_t)obs_data_get_int(settings, "title_color");
+    uint32_t status_use_color = obs_data_get_bool(settings, "status_use_color");
+    uint32_t status_color = (uint32_t)obs_data_get_int(settings, "status_color");
+    bool show_media_tag = obs_data_get_bool(settings, "show_media_tag");
+    bool text_changed = title_color != ctx->title_color || status_use_color != ctx->status_use_color ||
+                        status_color != ctx->status_color || show_media_tag != ctx->show_media_tag ||
+                        (media != ctx->media && (media == "both" || ctx->media == "both"));
+
+    {
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+
+        ctx->backend = backend;
+        ctx->username = username;
+        ctx->client_id = client_id;
+        ctx->endpoint = endpoint;
+        ctx->status = status;
+        ctx->media = media;
+        ctx->first_status = first_status;
+        ctx->scroll_speed = scroll_speed;
+        ctx->refresh_interval = refresh_interval;
+        ctx->evict_after = evict_after;
+        ctx->render_mode = render_mode;
+        ctx->cover_webp = cover_webp;
+        ctx->item_width = item_width;
+        ctx->item_gap = item_gap;
+        ctx->text_scale = text_scale;
+        ctx->text_background = text_background;
+        ctx->background_color = background_color;
+        ctx->background_padding = background_padding;
+        ctx->background_opacity = background_opacity;
+        ctx->title_color = title_color;
+        ctx->status_use_color = status_use_color;
+        ctx->status_color = status_color;
+        ctx->show_media_tag = show_media_tag;
+        if (query_changed) ctx->fetch_generation++;
+        if (text_changed) ctx->text_generation++;
+
+        // Display lists, composited cards and strip tiles all bake in the geometry
+        if (geometry_changed) {
+            update_layout_params(ctx);
+            for (auto &img : ctx->images) {
+                img.ops_valid = false;
+                img.card_valid = false;
+            }
+            release_strip_tiles(ctx);
+            ctx->strip_tiles.clear();
         }
-        if (img.title4_tex) {
-            ctx->pending_textures_free.push_back(img.title4_tex);
-            img.title4_tex = nullptr;
+    }
+
+    // Laid out again on the fetch thread once the edits settle, so typing
+    // in the dialog neither stalls it nor rasterizes the list per keystroke.
+    // A refetch lays the text out anyway.
+    if (text_changed && !query_changed) {
+        ctx->relayout_at = os_gettime_ns() + REFETCH_DEBOUNCE_NS;
+    }
+
+    if (query_changed) {
+        // The new list's pushes replace the old one's
+        {
+            std::lock_guard<std::mutex> lock(ctx->data_mutex);
+            companion_unsubscribe(ctx->companion);
+            if (backend == "companion") ctx->companion = companion_subscribe(list_key_for(ctx));
         }
-        if (img.status_tex) {
-            ctx->pending_textures_free.push_back(img.status_tex);
-            img.status_tex = nullptr;
+
+        // Require at least 3 characters before attempting to fetch
+        if (!has_query(backend, username)) {
+            blog(LOG_INFO, "Username too short or empty, skipping fetch");
+            ctx->refetch_at = 0;
+            return;
         }
+        // Started from the tick once the edits settle
+        ctx->refetch_at = os_gettime_ns() + REFETCH_DEBOUNCE_NS;
     }
+}
 
-    // Require at least 3 characters before attempting to fetch
-    if (ctx->username.empty() || ctx->username.length() < 3) {
-        blog(LOG_INFO, "Username too short or empty, skipping fetch");
-        return;
+// Called from the tick only: it is the one thread that starts and joins fetches
+static void start_fetch(mal_source *ctx)
+{
+    if (ctx->fetch_thread.joinable()) {
+        ctx->fetch_thread.join();
+    }
+
+    list_key key;
+    text_params p;
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        if (!has_query(ctx->backend, ctx->username)) return;
+        key = list_key_for(ctx);
+        p = get_text_params(ctx);
+        generation = ++ctx->fetch_generation;
     }
 
-    ctx->fetcher = std::make_unique<MALFetcher>(ctx->username);
+    ctx->refetch_at = 0;
+    ctx->seen_publications = list_store_publications(key);
+    ctx->fetching = true;
+    ctx->refs++;
+    g_fetch_threads++;
+    ctx->fetch_thread = std::thread(fetch_thread_main, ctx, std::move(key), p, generation);
+}
 
-    // Always restart fetch with the latest username; join any in-flight thread first
+// Called from the tick only, like start_fetch; shares its thread
+static void start_relayout(mal_source *ctx)
+{
     if (ctx->fetch_thread.joinable()) {
         ctx->fetch_thread.join();
     }
-    ctx->fetch_thread = std::thread(fetch_entries_async, ctx);
+
+    list_snapshot entries;
+    text_params p;
+    {
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        entries = ctx->entries;
+        p = get_text_params(ctx);
+    }
+
+    ctx->relayout_at = 0;
+    ctx->fetching = true;
+    ctx->refs++;
+    g_fetch_threads++;
+    ctx->fetch_thread = std::thread(relayout_thread_main, ctx, std::move(entries), p);
 }
 
-static void mal_source_tick(void *data, float seconds)
+static void tick_source(mal_source *ctx, float seconds)
 {
-    mal_source *ctx = (mal_source *)data;
+    // Settings are written on the UI thread; take one consistent copy
+    int evict_after, scroll_speed, item_width, item_gap, refresh_interval;
+    size_t entry_count; // an empty list still reaches the fetch scheduling below
+    {
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        evict_after = ctx->evict_after;
+        scroll_speed = ctx->scroll_speed;
+        item_width = ctx->item_width;
+        item_gap = ctx->item_gap;
+        refresh_interval = ctx->refresh_interval;
+        entry_count = ctx->entries->size();
+    }
 
-    if (ctx->entries.empty()) return;
+    // Hidden sources neither scroll nor refresh, and drop their GPU
+    // resources once the grace period is over
+    if (!ctx->showing) {
+        uint64_t evict_ns = (uint64_t)evict_after * 1000000000ULL;
+        if (!ctx->gpu_evicted && evict_after > 0 && os_gettime_ns() - ctx->hidden_since > evict_ns) {
+            evict_gpu_resources(ctx);
+        }
+        return;
+    }
+    if (ctx->warm_up_pending.exchange(false)) {
+        warm_up_visible(ctx);
+    }
+
+    // Covers only need the detail the output keeps: a canvas scaled down
+    // for streaming shows them smaller than item_width
+    struct obs_video_info ovi;
+    float canvas_scale = 1.0f;
+    if (obs_get_video_info(&ovi) && ovi.base_width > 0) {
+        canvas_scale = std::min(1.0f, (float)ovi.output_width / (float)ovi.base_width);
+    }
+    ctx->cover_px = (int)std::ceil(item_width * canvas_scale);
 
-    float speed_pixels_per_second = (float)ctx->scroll_speed;
+    float speed_pixels_per_second = (float)scroll_speed;
     ctx->scroll_offset += speed_pixels_per_second * seconds;
 
-    float total_width = (ctx->item_width + ctx->item_gap) * ctx->entries.size();
+    float total_width = (float)(item_width + item_gap) * entry_count;
     if (total_width > 0.0f) {
         ctx->scroll_offset = fmodf(ctx->scroll_offset, total_width);
         if (ctx->scroll_offset < 0.0f)
             ctx->scroll_offset += total_width;
+    } else {
+        ctx->scroll_offset = 0.0f;
     }
 
-    int visible_start = (int)(ctx->scroll_offset / (ctx->item_width + ctx->item_gap));
+    int visible_start = (int)(ctx->scroll_offset / (item_width + item_gap));
     int visible_count = 6; // Reduziert von 10 für bessere Performance
 
     // Removed synchronous image loading - causes lag
 
     uint64_t now = os_gettime_ns();
-    uint64_t refresh_ns = (uint64_t)ctx->refresh_interval * 1000000000ULL;
-    if (now - ctx->last_fetch_time > refresh_ns && !ctx->fetching) {
-        if (ctx->fetch_thread.joinable()) {
-            ctx->fetch_thread.join();
+    if (now - ctx->last_timing_log > 60ULL * 1000000000ULL) {
+        if (ctx->render_frames > 0) {
+            blog(LOG_INFO, "[MAL] Render callback: avg %.1f us, max %.1f us, %.1f state changes/frame over %u frames",
+                 (double)ctx->render_time_ns / ctx->render_frames / 1000.0,
+                 (double)ctx->render_time_max_ns / 1000.0,
+                 (double)ctx->render_state_changes / ctx->render_frames, ctx->render_frames);
         }
-        ctx->fetch_thread = std::thread(fetch_entries_async, ctx);
+        blog(LOG_INFO, "[MAL] Stats for '%s': %s", obs_source_get_name(ctx->source),
+             source_stats_describe(ctx->stats, "; ").c_str());
+        ctx->render_time_ns = 0;
+        ctx->render_state_changes = 0;
+        ctx->render_time_max_ns = 0;
+        ctx->render_frames = 0;
+        ctx->last_timing_log = now;
+    }
+
+    // A companion stream keeps the store current; a new publication of
+    // this source's list costs a store lookup, not a request
+    bool pushed;
+    bool published = false;
+    {
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        pushed = companion_connected(ctx->companion);
+        if (pushed) published = list_store_publications(list_key_for(ctx)) != ctx->seen_publications;
+    }
+
+    // A pending settings change goes first; a fetch already in flight for the
+    // old query is dropped when it lands
+    uint64_t refetch_at = ctx->refetch_at;
+    uint64_t relayout_at = ctx->relayout_at;
+    uint64_t refresh_ns = (uint64_t)refresh_interval * 1000000000ULL;
+    if (refetch_at != 0 && now >= refetch_at && !ctx->fetching) {
+        start_fetch(ctx);
+    } else if (relayout_at != 0 && now >= relayout_at && !ctx->fetching) {
+        start_relayout(ctx);
+    } else if (refetch_at == 0 && pushed && published && !ctx->fetching) {
+        start_fetch(ctx);
+    } else if (refetch_at == 0 && !pushed && now - ctx->last_fetch_time > refresh_ns && !ctx->fetching) {
+        start_fetch(ctx);
     }
 }
 
-static void mal_source_render(void *data, gs_effect_t *effect)
+static void mal_source_tick(void *data, float seconds)
 {
     mal_source *ctx = (mal_source *)data;
 
-    if (ctx->entries.empty()) return;
+    profile_start(PROFILE_TICK);
+    tick_source(ctx, seconds);
+    profile_end(PROFILE_TICK);
+}
 
-    std::lock_guard<std::mutex> lock(ctx->data_mutex);
+// Marks every strip tile showing card `index` (including its wrapped copies) for re-render
+static void invalidate_strip_tiles(mal_source *ctx, size_t index)
+{
+    if (ctx->strip_tiles.empty()) return;
+
+    const float total_width = ctx->layout.pitch * ctx->images.size();
+    const float x = index * ctx->layout.pitch;
+    for (float base : {x - total_width, x, x + total_width}) {
+        float left = (base - STRIP_CARD_MARGIN) / STRIP_TILE_WIDTH;
+        float right = (base + ctx->layout.item_width + STRIP_CARD_MARGIN) / STRIP_TILE_WIDTH;
+        for (long t = (long)std::floor(left); t <= (long)std::floor(right); t++) {
+            if (t >= 0 && (size_t)t < ctx->strip_tiles.size()) ctx->strip_tiles[t].valid = false;
+        }
+    }
+}
+
+static void build_card(mal_source *ctx, size_t index)
+{
+    auto &img = ctx->images[index];
+
+    card_textures textures;
+    textures.cover = (img.loaded && img.image) ? img.image->texture : nullptr;
+    for (int i = 0; i < 4; i++) {
+        textures.title[i] = img.title_tex[i];
+        textures.title_w[i] = img.title_w[i];
+        textures.title_h[i] = img.title_h[i];
+    }
+    textures.status = img.status_tex;
+    textures.status_w = img.status_w;
+    textures.status_h = img.status_h;
+
+    card_layout_build(ctx->layout, textures, img.ops);
+    img.ops_valid = true;
+    img.card_valid = false;
+    invalidate_strip_tiles(ctx, index);
+}
+
+static gs_texrender_t *take_render_target(mal_source *ctx)
+{
+    if (ctx->card_pool.empty()) return gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+    gs_texrender_t *render = ctx->card_pool.back();
+    ctx->card_pool.pop_back();
+    return render;
+}
+
+// Creates the texture of a cover the workers have decoded, if the budget allows
+static void upload_cover(mal_source *ctx, mal_source::LoadedImage &img, upload_budget &budget)
+{
+    if (!img.cover || img.cover->state != cover_state::ready) return;
+    if (!upload_budget_allows(budget, upload_kind::cover)) return;
+
+    uint64_t start = os_gettime_ns();
+    profile_start(PROFILE_UPLOAD_COVER);
+    gs_image_file_t *image = cover_loader_take(img.cover);
+    img.cover.reset();
+    gs_image_file_init_texture(image);
+    profile_end(PROFILE_UPLOAD_COVER);
+    upload_budget_spend(budget, upload_kind::cover, os_gettime_ns() - start);
+
+    if (image->texture) {
+        if (img.image) ctx->pending_images_free.push_back(img.image);
+        img.image = image;
+        img.loaded = true;
+        img.cover_failures = 0;
+        img.ops_valid = false;
+    } else {
+        blog(LOG_WARNING, "Failed to load image: %s", img.cover_url.c_str());
+        // Kept (unloaded) on a card without a cover so it is not retried
+        if (img.image) {
+            ctx->pending_images_free.push_back(image);
+        } else {
+            img.image = image;
+        }
+    }
+}
+
+// Delay before a card asks again for a cover that failed to load: 10 s,
+// doubling per failure in a row, at most 10 minutes
+static uint64_t cover_retry_delay_ns(uint32_t failures)
+{
+    const uint64_t base_ns = 10000000000ULL;
+    const uint64_t max_ns = 600000000000ULL;
+    uint32_t shift = std::min<uint32_t>(failures > 0 ? failures - 1 : 0, 6);
+    return std::min(max_ns, base_ns << shift);
+}
+
+// Covers are downloaded and decoded on the cover workers. The smallest
+// variant that fills the card is asked for, and a card that grows past
+// the one it shows gets the next size up while it keeps showing the old one.
+static void request_cover(mal_source *ctx, mal_source::LoadedImage &img)
+{
+    // A failed download (network error, host backing off, disk full) is
+    // usually temporary; a cover that downloaded but would not upload stays
+    // as an unloaded image and is not asked for again
+    if (img.cover && img.cover->state == cover_state::failed) {
+        img.cover.reset();
+        img.cover_failures++;
+        img.cover_retry_at = os_gettime_ns() + cover_retry_delay_ns(img.cover_failures);
+    }
+    if (img.url.empty() || img.cover || os_gettime_ns() < img.cover_retry_at) return;
+
+    std::string want = cover_url_for_width(img.url, ctx->cover_px);
+    bool upgrade = img.loaded && cover_url_width(want) > cover_url_width(img.cover_url);
+    if ((!img.loaded && !img.image) || upgrade) {
+        img.cover_url = want;
+        img.cover = cover_loader_request(want, ctx->cover_webp);
+    }
+}
+
+// Cards past the right edge (where new cards scroll in) whose covers are
+// requested, and whose textures are uploaded, ahead of time
+static const long UPLOAD_LOOKAHEAD = 3;
+
+// Spends this frame's upload budget on the cards nearest the viewport:
+// visible ones first, then the ones about to scroll in. Their covers are
+// requested here too, so a card scrolling in finds its cover decoded.
+static void schedule_uploads(mal_source *ctx, float view_width)
+{
+    upload_budget &budget = ctx->upload_frame;
+    upload_budget_begin(budget, ctx->upload_cost);
+
+    const size_t count = std::min(ctx->entries->size(), ctx->images.size());
+    const float pitch = ctx->layout.pitch;
+    if (count == 0 || pitch <= 0.0f) return;
+
+    struct candidate {
+        size_t index;
+        float distance; // pixels outside the viewport, 0 if visible
+    };
+    profile_start(PROFILE_CULL);
+    std::vector<candidate> queue;
+    const long first = (long)std::floor(ctx->scroll_offset / pitch) - 1;
+    const long last = (long)std::floor((ctx->scroll_offset + view_width) / pitch) + UPLOAD_LOOKAHEAD;
+    for (long j = first; j <= last && queue.size() < count; j++) {
+        size_t i = (size_t)(((j % (long)count) + (long)count) % (long)count);
+        float x = j * pitch - ctx->scroll_offset;
+        float distance = std::max({0.0f, x - view_width, -(x + ctx->layout.item_width)});
+        auto same = [i](const candidate &c) { return c.index == i; };
+        if (std::find_if(queue.begin(), queue.end(), same) == queue.end()) queue.push_back({i, distance});
+    }
+    std::stable_sort(queue.begin(), queue.end(),
+                     [](const candidate &a, const candidate &b) { return a.distance < b.distance; });
+    profile_end(PROFILE_CULL);
+
+    profile_start(PROFILE_UPLOADS);
+    for (const auto &c : queue) {
+        request_cover(ctx, ctx->images[c.index]);
+        ensure_textures_for_entry(ctx, c.index, &budget);
+        upload_cover(ctx, ctx->images[c.index], budget);
+    }
+    profile_end(PROFILE_UPLOADS);
+}
+
+// Requests the cover a visible card needs (if schedule_uploads has not)
+// and brings its display list up to date; uploads were done by schedule_uploads
+static void prepare_card(mal_source *ctx, size_t index)
+{
+    request_cover(ctx, ctx->images[index]);
+    if (!ctx->images[index].ops_valid) build_card(ctx, index);
+}
+
+// Composed cards kept beyond those in view, the most recently shown first,
+// so a card scrolling back in within a lap of a short list is not composed
+// again. At ~200x400 px a card target is about 320 KB.
+static const size_t CARD_KEEP_OFFSCREEN = 8;
+
+static void render_cards(mal_source *ctx, float view_width, bool use_cards)
+{
+    const float pitch = ctx->layout.pitch;
+    const float item_width = ctx->layout.item_width;
+    const size_t count = std::min(ctx->entries->size(), ctx->images.size());
+    std::vector<size_t> visible_cards;
+
+    profile_start(PROFILE_CULL);
+    card_span span = card_visible_span(ctx->layout, count, ctx->scroll_offset, view_width);
+    profile_end(PROFILE_CULL);
+    for (size_t k = 0; k < span.count; k++) {
+        size_t i = (span.first + k) % count;
+        float x = span.x0 + k * pitch;
+        if (x + item_width < 0 || x > view_width) continue;
+
+        auto &img = ctx->images[i];
+        prepare_card(ctx, i);
+
+        if (!use_cards) {
+            card_queue(img.ops, x, ctx->batch);
+            continue;
+        }
+
+        // Compose the card once, then draw it as one sprite until it changes
+        if (!img.card.render) img.card.render = take_render_target(ctx);
+        if (std::find(visible_cards.begin(), visible_cards.end(), i) == visible_cards.end()) {
+            visible_cards.push_back(i);
+        }
+        if (!img.card_valid) {
+            img.card_valid = card_compose(ctx->layout, img.ops, ctx->white_texture, img.card);
+        }
+        if (img.card_valid) card_queue_image(img.card, x, ctx->batch);
+    }
 
+    // Cards that scrolled out of view keep their render target until
+    // CARD_KEEP_OFFSCREEN more recently shown ones have left it too
+    const size_t keep = visible_cards.size() + CARD_KEEP_OFFSCREEN;
+    for (size_t i : ctx->resident_cards) {
+        if (i >= ctx->images.size() ||
+            std::find(visible_cards.begin(), visible_cards.end(), i) != visible_cards.end()) {
+            continue;
+        }
+        if (visible_cards.size() < keep) {
+            visible_cards.push_back(i);
+        } else {
+            release_card(ctx, ctx->images[i]);
+        }
+    }
+    ctx->resident_cards.swap(visible_cards);
+}
+
+// Brings one strip tile up to date, re-rendering it only if a card in it changed
+static void update_strip_tile(mal_source *ctx, size_t t, uint32_t tile_w, uint32_t tile_h)
+{
+    const size_t count = ctx->images.size();
+    const float pitch = ctx->layout.pitch;
+    const float x0 = (float)t * STRIP_TILE_WIDTH;
+    const long first = (long)std::floor((x0 - ctx->layout.item_width - STRIP_CARD_MARGIN) / pitch);
+    const long last = (long)std::floor((x0 + tile_w + STRIP_CARD_MARGIN) / pitch);
+
+    // Cards are indexed modulo count so the seam shows the wrapped neighbours
+    for (long j = first; j <= last; j++) {
+        size_t i = (size_t)(((j % (long)count) + (long)count) % (long)count);
+        prepare_card(ctx, i);
+    }
+
+    auto &tile = ctx->strip_tiles[t];
+    if (tile.valid) return;
+    if (!tile.render) tile.render = take_render_target(ctx);
+    if (!card_target_begin(tile.render, x0, 0.0f, tile_w, tile_h)) return;
+    draw_batch tile_batch;
+    for (long j = first; j <= last; j++) {
+        size_t i = (size_t)(((j % (long)count) + (long)count) % (long)count);
+        card_queue(ctx->images[i].ops, j * pitch, tile_batch);
+    }
+    draw_batch_flush(tile_batch, ctx->layout.background_color, ctx->white_texture);
+    ctx->render_state_changes += tile_batch.state_changes;
+    card_target_end(tile.render);
+    tile.valid = true;
+}
+
+// Plays the pre-rendered ribbon back as one blit per tile in view (two at the seam)
+static void render_strip(mal_source *ctx, float view_width, float view_height)
+{
+    const size_t count = std::min(ctx->entries->size(), ctx->images.size());
+    const float total_width = ctx->layout.pitch * count;
+    const uint32_t tile_h = (uint32_t)view_height;
+    if (count == 0 || total_width <= 0.0f || tile_h == 0) return;
+
+    size_t tile_count = (size_t)std::ceil(total_width / STRIP_TILE_WIDTH);
+    if (ctx->strip_tiles.size() != tile_count) {
+        release_strip_tiles(ctx);
+        ctx->strip_tiles.assign(tile_count, mal_source::StripTile{nullptr, false});
+    }
+
+    std::vector<size_t> visible_tiles;
+
+    // Like the card path, the ribbon wraps at most once
+    const float scroll = ctx->scroll_offset;
+    const float end = std::min(scroll + view_width, 2.0f * total_width);
+    float p = scroll;
+    while (p < end) {
+        float strip_x = fmodf(p, total_width);
+        size_t t = std::min((size_t)(strip_x / STRIP_TILE_WIDTH), tile_count - 1);
+        float tile_x0 = (float)t * STRIP_TILE_WIDTH;
+        uint32_t tile_w = (uint32_t)std::min((float)STRIP_TILE_WIDTH, total_width - tile_x0);
+        float off = strip_x - tile_x0;
+        float w = std::min((float)tile_w - off, end - p);
+        if (w <= 0.0f) break;
+
+        if (std::find(visible_tiles.begin(), visible_tiles.end(), t) == visible_tiles.end()) {
+            visible_tiles.push_back(t);
+            update_strip_tile(ctx, t, tile_w, tile_h);
+        }
+
+        // Blit whole texels and shift by the sub-pixel remainder so pieces abut exactly
+        auto &tile = ctx->strip_tiles[t];
+        if (tile.valid) {
+            uint32_t sub_x = (uint32_t)off;
+            uint32_t sub_w = std::min(tile_w, (uint32_t)std::ceil(off + w)) - sub_x;
+            card_queue_region(gs_texrender_get_texture(tile.render),
+                              (p - scroll) - (off - sub_x), sub_x, sub_w, tile_h, ctx->batch);
+        }
+        p += w;
+    }
+
+    // Tiles that scrolled out of view give their render target back
+    for (size_t t : ctx->resident_tiles) {
+        if (t < ctx->strip_tiles.size() &&
+            std::find(visible_tiles.begin(), visible_tiles.end(), t) == visible_tiles.end()) {
+            auto &tile = ctx->strip_tiles[t];
+            if (tile.render) ctx->card_pool.push_back(tile.render);
+            tile.render = nullptr;
+            tile.valid = false;
+        }
+    }
+    ctx->resident_tiles.swap(visible_tiles);
+}
+
+static void render_entries(mal_source *ctx)
+{
     process_pending_gpu_frees(ctx);
 
-    gs_effect_t *solid = obs_get_base_effect(OBS_EFFECT_DEFAULT);
-    gs_technique_t *tech = gs_effect_get_technique(solid, "Draw");
+    if (ctx->layout.text_background && !ctx->white_texture) {
+        ctx->white_texture = text_cache_acquire_white();
+    }
 
-    float total_width = (ctx->item_width + ctx->item_gap) * ctx->entries.size();
-    float x_offset = -ctx->scroll_offset;
+    const float view_width = (float)obs_source_get_width(ctx->source);
+    const float view_height = (float)obs_source_get_height(ctx->source);
+    const bool use_strip = ctx->render_mode == "strip";
+    const bool use_cards = ctx->render_mode == "cards";
 
-    int images_loaded_this_frame = 0;
-    const int max_images_per_frame = 1; // Only load 1 image per frame to avoid stuttering
+    // Give back render targets held by modes that are not active
+    if (!use_cards && !ctx->resident_cards.empty()) {
+        for (size_t i : ctx->resident_cards) {
+            if (i < ctx->images.size()) release_card(ctx, ctx->images[i]);
+        }
+        ctx->resident_cards.clear();
+    }
+    if (!use_strip && !ctx->strip_tiles.empty()) {
+        release_strip_tiles(ctx);
+        ctx->strip_tiles.clear();
+    }
 
-    for (int pass = 0; pass < 2; pass++) {
-        float base_x = x_offset + (pass > 0 ? total_width : 0.0f);
+    schedule_uploads(ctx, view_width);
 
-        for (size_t i = 0; i < ctx->entries.size(); i++) {
-            float x = base_x + i * (ctx->item_width + ctx->item_gap);
+    if (use_strip) {
+        render_strip(ctx, view_width, view_height);
+    } else {
+        render_cards(ctx, view_width, use_cards);
+    }
 
-            uint32_t source_width = obs_source_get_width(ctx->source);
-            if (x + ctx->item_width < 0 || x > source_width) continue;
+    // Replay the frame grouped by effect and texture
+    draw_batch_flush(ctx->batch, ctx->layout.background_color, ctx->white_texture);
+    ctx->render_state_changes += ctx->batch.state_changes;
+}
 
-            // Load image asynchronously if needed (non-blocking), but limit per frame
-            if (i < ctx->images.size() && !ctx->images[i].loaded && !ctx->images[i].url.empty() && images_loaded_this_frame < max_images_per_frame) {
-                auto &img = ctx->images[i];
-                if (!img.image) {
-                    img.image = new gs_image_file_t();
-                    gs_image_file_init(img.image, img.url.c_str());
-                    gs_image_file_init_texture(img.image);
-                    if (img.image->texture) {
-                        img.loaded = true;
-                    }
-                    images_loaded_this_frame++;
-                }
-            }
+static const uint64_t RESIDENCY_SAMPLE_NS = 1000000000ULL;
 
-            // Always create text textures for visible items
-            if (i < ctx->images.size()) {
-                ensure_textures_for_entry(ctx, i);
-            }
+// Counts the textures the source holds and their approximate size (4 bytes
+// per pixel). Text textures are counted even when the text cache shares
+// them with another source. Caller holds data_mutex.
+static void sample_residency(mal_source *ctx)
+{
+    uint64_t textures = 0;
+    uint64_t bytes = 0;
+    auto add_texture = [&](gs_texture_t *tex) {
+        if (!tex) return;
+        textures++;
+        bytes += (uint64_t)gs_texture_get_width(tex) * gs_texture_get_height(tex) * 4;
+    };
+    auto add_render = [&](gs_texrender_t *render) {
+        if (render) add_texture(gs_texrender_get_texture(render));
+    };
+
+    for (const auto &img : ctx->images) {
+        if (img.image && img.image->texture) {
+            textures++;
+            bytes += (uint64_t)img.image->cx * img.image->cy * 4;
+        }
+        for (int i = 0; i < 4; i++) add_texture(img.title_tex[i]);
+        add_texture(img.status_tex);
+        add_render(img.card.render);
+    }
+    for (const auto &tile : ctx->strip_tiles) add_render(tile.render);
+    for (auto *render : ctx->card_pool) add_render(render);
+
+    ctx->stats.resident_textures = textures;
+    ctx->stats.vram_bytes = bytes;
+}
 
-            if (i < ctx->images.size() && ctx->images[i].loaded && ctx->images[i].image && ctx->images[i].image->texture) {
-                auto &img = ctx->images[i];
-
-                gs_effect_set_texture(gs_effect_get_param_by_name(solid, "image"), img.image->texture);
-
-                uint32_t img_width = gs_texture_get_width(img.image->texture);
-                uint32_t img_height = gs_texture_get_height(img.image->texture);
-                float scale = (float)ctx->item_width / img_width;
-                float scaled_height = img_height * scale;
-
-                // Cover
-                gs_technique_begin(tech);
-                gs_technique_begin_pass(tech, 0);
-
-                gs_matrix_push();
-                gs_matrix_translate3f(x, 0.0f, 0.0f);
-                gs_matrix_scale3f(scale, scale, 1.0f);
-                gs_draw_sprite(img.image->texture, 0, img_width, img_height);
-                gs_matrix_pop();
-
-                gs_technique_end_pass(tech);
-                gs_technique_end(tech);
-
-                auto draw_tex = [&](gs_texture_t *tex, uint32_t tw, uint32_t th, float draw_x, float draw_y, float tex_scale) {
-                    if (!tex || tw == 0 || th == 0 || tex_scale <= 0.0f) return;
-                    
-                    // Draw background if enabled
-                    if (ctx->text_background) {
-                        // Lazy-create white texture if needed
-                        if (!ctx->white_texture) {
-                            uint32_t white_pixel = 0xFFFFFFFF;
-                            const uint8_t *white_data = (const uint8_t*)&white_pixel;
-                            ctx->white_texture = gs_texture_create(1, 1, GS_RGBA, 1, &white_data, 0);
-                        }
-                        
-                        if (ctx->white_texture) {
-                            float bg_width = tw * tex_scale + ctx->background_padding * 2.0f;
-                            float bg_height = th * tex_scale + ctx->background_padding * 2.0f;
-                            float bg_x = draw_x - ctx->background_padding;
-                            float bg_y = draw_y - ctx->background_padding;
-                            
-                            gs_effect_t *solid_bg = obs_get_base_effect(OBS_EFFECT_SOLID);
-                            gs_eparam_t *color_param = gs_effect_get_param_by_name(solid_bg, "color");
-                            gs_technique_t *solid_tech = gs_effect_get_technique(solid_bg, "Solid");
-                            
-                            if (color_param && solid_tech) {
-                                struct vec4 bg_color;
-                                uint32_t c = ctx->background_color;
-                                bg_color.x = (float)((c >> 0) & 0xFF) / 255.0f;  // R
-                                bg_color.y = (float)((c >> 8) & 0xFF) / 255.0f;  // G
-                                bg_color.z = (float)((c >> 16) & 0xFF) / 255.0f; // B
-                                bg_color.w = ctx->background_opacity;             // Alpha from slider
-                                gs_effect_set_vec4(color_param, &bg_color);
-                                
-                                gs_technique_begin(solid_tech);
-                                gs_technique_begin_pass(solid_tech, 0);
-                                gs_matrix_push();
-                                gs_matrix_translate3f(bg_x, bg_y, 0.0f);
-                                gs_matrix_scale3f(bg_width, bg_height, 1.0f);
-                                gs_draw_sprite(ctx->white_texture, 0, 1, 1);
-                                gs_matrix_pop();
-                                gs_technique_end_pass(solid_tech);
-                                gs_technique_end(solid_tech);
-                            }
-                        }
-                    }
-                    
-                    gs_effect_set_texture(gs_effect_get_param_by_name(solid, "image"), tex);
-                    gs_technique_begin(tech);
-                    gs_technique_begin_pass(tech, 0);
-                    gs_matrix_push();
-                    gs_matrix_translate3f(draw_x, draw_y, 0.0f);
-                    gs_matrix_scale3f(tex_scale, tex_scale, 1.0f);
-                    gs_draw_sprite(tex, 0, tw, th);
-                    gs_matrix_pop();
-                    gs_technique_end_pass(tech);
-                    gs_technique_end(tech);
-                };
-
-                // Status badge near the top-left of the cover
-                if (img.status_tex && img.status_w > 0 && img.status_h > 0) {
-                    blog(LOG_WARNING, "[MAL-DEBUG] Rendering status badge at x=%.1f tex=%p w=%d h=%d", x + 6.0f, img.status_tex, img.status_w, img.status_h);
-                    float avail = (float)ctx->item_width - 12.0f - (ctx->text_background ? ctx->background_padding * 2.0f : 0.0f);
-                    if (avail < 1.0f) avail = 1.0f;
-                    // Mindestens Skalierung 1.5 für bessere Sichtbarkeit
-                    float badge_scale = (img.status_w > 0 && avail > 0.0f)
-                        ? std::max(1.5f, std::min(3.0f, std::min(ctx->text_scale, avail / (float)img.status_w)))
-                        : std::max(1.5f, ctx->text_scale);
-                    draw_tex(img.status_tex, img.status_w, img.status_h, x + 6.0f, 6.0f, badge_scale);
-                } else {
-                    blog(LOG_WARNING, "[MAL-DEBUG] Status badge not rendered: tex=%p w=%d h=%d", 
-                         img.status_tex, img.status_w, img.status_h);
-                }
-
-                // Title under the cover
-                if (img.title_tex) {
-                    float avail = (float)ctx->item_width - 12.0f - (ctx->text_background ? ctx->background_padding * 2.0f : 0.0f);
-                    if (avail < 1.0f) avail = 1.0f;
-                    float base_y = scaled_height + 8.0f;
-                    float line_spacing = 4.0f;
-                    float y = base_y;
-
-                    auto draw_line = [&](gs_texture_t *tex, uint32_t tw, uint32_t th) {
-                        if (!tex || tw == 0 || th == 0) return;
-                        float scale = (tw > 0 && avail > 0.0f)
-                            ? std::min(3.0f, std::min(ctx->text_scale, avail / (float)tw))
-                            : ctx->text_scale;
-                        draw_tex(tex, tw, th, x + 6.0f, y, scale);
-                        y += th * scale + line_spacing;
-                    };
-
-                    draw_line(img.title_tex, img.title_w, img.title_h);
-                    draw_line(img.title2_tex, img.title2_w, img.title2_h);
-                    draw_line(img.title3_tex, img.title3_w, img.title3_h);
-                    draw_line(img.title4_tex, img.title4_w, img.title4_h);
-                }
-            } else {
-                // Render text/status even without cover image
-                if (i < ctx->images.size()) {
-                    auto &img = ctx->images[i];
-                    
-                    // Status badge
-                    if (img.status_tex && img.status_w > 0 && img.status_h > 0) {
-                        float avail = (float)ctx->item_width - 12.0f - (ctx->text_background ? ctx->background_padding * 2.0f : 0.0f);
-                        if (avail < 1.0f) avail = 1.0f;
-                        float badge_scale = (img.status_w > 0 && avail > 0.0f)
-                            ? std::max(1.5f, std::min(3.0f, std::min(ctx->text_scale, avail / (float)img.status_w)))
-                            : std::max(1.5f, ctx->text_scale);
-                        
-                        auto draw_tex = [&](gs_texture_t *tex, uint32_t tw, uint32_t th, float draw_x, float draw_y, float tex_scale) {
-                            if (!tex || tw == 0 || th == 0 || tex_scale <= 0.0f) return;
-                            
-                            if (ctx->text_background) {
-                                if (!ctx->white_texture) {
-                                    uint32_t white_pixel = 0xFFFFFFFF;
-                                    const uint8_t *white_data = (const uint8_t*)&white_pixel;
-                                    ctx->white_texture = gs_texture_create(1, 1, GS_RGBA, 1, &white_data, 0);
-                                }
-                                
-                                if (ctx->white_texture) {
-                                    float bg_width = tw * tex_scale + ctx->background_padding * 2.0f;
-                                    float bg_height = th * tex_scale + ctx->background_padding * 2.0f;
-                                    float bg_x = draw_x - ctx->background_padding;
-                                    float bg_y = draw_y - ctx->background_padding;
-                                    
-                                    gs_effect_t *solid_bg = obs_get_base_effect(OBS_EFFECT_SOLID);
-                                    gs_eparam_t *color_param = gs_effect_get_param_by_name(solid_bg, "color");
-                                    gs_technique_t *solid_tech = gs_effect_get_technique(solid_bg, "Solid");
-                                    
-                                    if (color_param && solid_tech) {
-                                        struct vec4 bg_color;
-                                        uint32_t c = ctx->background_color;
-                                        bg_color.x = (float)((c >> 0) & 0xFF) / 255.0f;
-                                        bg_color.y = (float)((c >> 8) & 0xFF) / 255.0f;
-                                        bg_color.z = (float)((c >> 16) & 0xFF) / 255.0f;
-                                        bg_color.w = ctx->background_opacity;
-                                        gs_effect_set_vec4(color_param, &bg_color);
-                                        
-                                        gs_technique_begin(solid_tech);
-                                        gs_technique_begin_pass(solid_tech, 0);
-                                        gs_matrix_push();
-                                        gs_matrix_translate3f(bg_x, bg_y, 0.0f);
-                                        gs_matrix_scale3f(bg_width, bg_height, 1.0f);
-                                        gs_draw_sprite(ctx->white_texture, 0, 1, 1);
-                                        gs_matrix_pop();
-                                        gs_technique_end_pass(solid_tech);
-                                        gs_technique_end(solid_tech);
-                                    }
-                                }
-                            }
-                            
-                            gs_effect_set_texture(gs_effect_get_param_by_name(solid, "image"), tex);
-                            gs_technique_begin(tech);
-                            gs_technique_begin_pass(tech, 0);
-                            gs_matrix_push();
-                            gs_matrix_translate3f(draw_x, draw_y, 0.0f);
-                            gs_matrix_scale3f(tex_scale, tex_scale, 1.0f);
-                            gs_draw_sprite(tex, 0, tw, th);
-                            gs_matrix_pop();
-                            gs_technique_end_pass(tech);
-                            gs_technique_end(tech);
-                        };
-                        
-                        draw_tex(img.status_tex, img.status_w, img.status_h, x + 6.0f, 6.0f, badge_scale);
-                    }
-                }
+static void mal_source_render(void *data, gs_effect_t *effect)
+{
+    UNUSED_PARAMETER(effect);
+    mal_source *ctx = (mal_source *)data;
+
+    // The fetch thread swaps `entries` under data_mutex, so even the empty
+    // check has to wait for it
+    uint64_t start = os_gettime_ns();
+    const uint64_t state_changes = ctx->render_state_changes;
+    {
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        if (ctx->entries->empty()) return;
+        profile_start(PROFILE_RENDER);
+        render_entries(ctx);
+        if (start - ctx->last_residency_sample > RESIDENCY_SAMPLE_NS) {
+            sample_residency(ctx);
+            ctx->last_residency_sample = start;
+        }
+    }
+    uint64_t elapsed = os_gettime_ns() - start;
+    source_stats_frame(ctx->stats, elapsed, ctx->upload_frame.uploads, ctx->upload_frame.deferred,
+                       ctx->render_state_changes - state_changes);
+
+    ctx->render_time_ns += elapsed;
+    if (elapsed > ctx->render_time_max_ns) ctx->render_time_max_ns = elapsed;
+    ctx->render_frames++;
+    profile_end(PROFILE_RENDER);
+}
+
+// Runs in the graphics thread (tick) once the grace period after hiding is over
+static void evict_gpu_resources(mal_source *ctx)
+{
+    size_t covers = 0;
+    int evict_after;
+    {
+        std::lock_guard<std::mutex> lock(ctx->data_mutex);
+        evict_after = ctx->evict_after;
+        for (auto &img : ctx->images) {
+            if (img.image) {
+                ctx->pending_images_free.push_back(img.image);
+                img.image = nullptr;
+                covers++;
             }
+            img.loaded = false;
+            img.cover.reset();
+            release_text_textures(ctx, img);
+            release_card(ctx, img);
+        }
+        ctx->resident_cards.clear();
+        release_strip_tiles(ctx);
+        ctx->strip_tiles.clear();
+        process_pending_gpu_frees(ctx);
+
+        obs_enter_graphics();
+        for (auto *render : ctx->card_pool) {
+            gs_texrender_destroy(render);
         }
+        ctx->card_pool.clear();
+        text_cache_release(ctx->white_texture);
+        ctx->white_texture = nullptr;
+        obs_leave_graphics();
+        sample_residency(ctx);
     }
+
+    ctx->gpu_evicted = true;
+    blog(LOG_INFO, "[MAL] Source hidden for %d s, released %zu covers and all text/card textures",
+         evict_after, covers);
+}
+
+// Prepares the cards around the viewport right after the source is shown
+// again, so the first visible frame has its text and display lists ready.
+// Covers follow through the regular per-frame loading path.
+static void warm_up_visible(mal_source *ctx)
+{
+    std::lock_guard<std::mutex> lock(ctx->data_mutex);
+
+    const size_t count = std::min(ctx->layouts.size(), ctx->images.size());
+    if (count == 0) return;
+
+    const float view_width = (float)obs_source_get_width(ctx->source);
+    card_span span = card_visible_span(ctx->layout, count, ctx->scroll_offset, view_width);
+
+    obs_enter_graphics();
+    for (size_t k = 0; k < span.count + 1 && k < count; k++) {
+        size_t i = (span.first + k) % count;
+        // Runs whose pixels were dropped after the first upload are
+        // rasterized again by the cache on a miss
+        ensure_textures_for_entry(ctx, i);
+        if (!ctx->images[i].ops_valid) build_card(ctx, i);
+    }
+    obs_leave_graphics();
+
+    ctx->gpu_evicted = false;
+}
+
+static void mal_source_show(void *data)
+{
+    mal_source *ctx = (mal_source *)data;
+    ctx->showing = true;
+    if (ctx->gpu_evicted) ctx->warm_up_pending = true;
+}
+
+static void mal_source_hide(void *data)
+{
+    mal_source *ctx = (mal_source *)data;
+    ctx->hidden_since = os_gettime_ns();
+    ctx->showing = false;
 }
 
 static uint32_t mal_source_get_width(void *data)
@@ -752,14 +1427,21 @@ static uint32_t mal_source_get_height(void *data)
 
 static void mal_source_get_defaults(obs_data_t *settings)
 {
+    obs_data_set_default_string(settings, "backend", "mal");
     obs_data_set_default_string(settings, "username", "");
+    obs_data_set_default_string(settings, "client_id", "");
+    obs_data_set_default_string(settings, "endpoint", "http://localhost:3000");
     obs_data_set_default_string(settings, "status", "READING");
     obs_data_set_default_string(settings, "media", "manga");
+    obs_data_set_default_string(settings, "first_status", "WATCHING");
     obs_data_set_default_int(settings, "scroll_speed", 50);
     obs_data_set_default_int(settings, "item_width", 250);
     obs_data_set_default_int(settings, "item_gap", 30);
     obs_data_set_default_int(settings, "refresh_interval", 300);
+    obs_data_set_default_int(settings, "evict_after", 120);
     obs_data_set_default_double(settings, "text_scale", 2.5);
+    obs_data_set_default_string(settings, "render_mode", "cards");
+    obs_data_set_default_string(settings, "cover_format", "webp");
     
     // Text colors - RGBA format (0xRRGGBBAA)
     obs_data_set_default_int(settings, "title_color", 0xFFFFFFFF); // white
@@ -772,13 +1454,33 @@ static void mal_source_get_defaults(obs_data_t *settings)
     obs_data_set_default_double(settings, "background_opacity", 0.8);
 }
 
-static obs_properties_t *mal_source_get_properties(void *data)
+static std::string stats_summary(void *data)
 {
-    UNUSED_PARAMETER(data);
+    if (!data) return "No statistics yet";
+    return source_stats_describe(((mal_source *)data)->stats, "\n");
+}
 
+static bool stats_refresh_clicked(obs_properties_t *props, obs_property_t *property, void *data)
+{
+    UNUSED_PARAMETER(property);
+    obs_property_set_description(obs_properties_get(props, "stats_summary"), stats_summary(data).c_str());
+    return true;
+}
+
+static obs_properties_t *mal_source_get_properties(void *data)
+{
     obs_properties_t *props = obs_properties_create();
 
-    obs_properties_add_text(props, "username", "MyAnimeList Username", OBS_TEXT_DEFAULT);
+    obs_property_t *backend_list = obs_properties_add_list(props, "backend", "List Source",
+                                                           OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+    obs_property_list_add_string(backend_list, "MyAnimeList (web pages)", "mal");
+    obs_property_list_add_string(backend_list, "MyAnimeList (API, needs client ID)", "mal_api");
+    obs_property_list_add_string(backend_list, "AniList", "anilist");
+    obs_property_list_add_string(backend_list, "Companion server (server.js)", "companion");
+
+    obs_properties_add_text(props, "username", "Username", OBS_TEXT_DEFAULT);
+    obs_properties_add_text(props, "client_id", "MyAnimeList API Client ID", OBS_TEXT_PASSWORD);
+    obs_properties_add_text(props, "endpoint", "Companion Server URL", OBS_TEXT_DEFAULT);
 
     obs_property_t *media_list = obs_properties_add_list(props, "media", "Media Type",
                                                          OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
@@ -795,11 +1497,31 @@ static obs_properties_t *mal_source_get_properties(void *data)
     obs_property_list_add_string(status_list, "Plan to Read/Watch", "PLANNING");
     obs_property_list_add_string(status_list, "All", "ALL");
 
+    obs_property_t *first_list = obs_properties_add_list(props, "first_status", "Show First (Status Filter = All)",
+                                                         OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+    obs_property_list_add_string(first_list, "Reading/Watching", "WATCHING");
+    obs_property_list_add_string(first_list, "Completed", "COMPLETED");
+    obs_property_list_add_string(first_list, "On Hold", "PAUSED");
+    obs_property_list_add_string(first_list, "Dropped", "DROPPED");
+    obs_property_list_add_string(first_list, "Plan to Read/Watch", "PLANNING");
+
     obs_properties_add_int_slider(props, "scroll_speed", "Scroll Speed (px/s)", 10, 200, 5);
     obs_properties_add_int_slider(props, "item_width", "Item Width", 100, 500, 10);
     obs_properties_add_int_slider(props, "item_gap", "Gap Between Items", 0, 100, 5);
     obs_properties_add_int_slider(props, "refresh_interval", "Refresh Interval (seconds)", 60, 3600, 60);
+    obs_properties_add_int_slider(props, "evict_after", "Free GPU Memory When Hidden For (seconds, 0 = never)", 0, 1800, 30);
     obs_properties_add_float_slider(props, "text_scale", "Text Scale", 0.5, 5.0, 0.1);
+
+    obs_property_t *mode_list = obs_properties_add_list(props, "render_mode", "Render Mode",
+                                                        OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+    obs_property_list_add_string(mode_list, "Cached Cards", "cards");
+    obs_property_list_add_string(mode_list, "Cached Strip", "strip");
+    obs_property_list_add_string(mode_list, "Direct", "direct");
+
+    obs_property_t *cover_list = obs_properties_add_list(props, "cover_format", "Cover Format",
+                                                         OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+    obs_property_list_add_string(cover_list, "WebP when available (smaller)", "webp");
+    obs_property_list_add_string(cover_list, "Original (JPEG)", "jpeg");
     
     // Text appearance
     obs_properties_add_color(props, "title_color", "Title Color");
@@ -811,6 +1533,12 @@ static obs_properties_t *mal_source_get_properties(void *data)
     obs_properties_add_float_slider(props, "background_opacity", "Background Opacity", 0.0, 1.0, 0.05);
     obs_properties_add_float_slider(props, "background_padding", "Background Padding", 0.0, 20.0, 0.5);
 
+    // Read-only statistics, as of opening the dialog or the last refresh
+    obs_properties_t *stats = obs_properties_create();
+    obs_properties_add_text(stats, "stats_summary", stats_summary(data).c_str(), OBS_TEXT_INFO);
+    obs_properties_add_button(stats, "stats_refresh", "Refresh Statistics", stats_refresh_clicked);
+    obs_properties_add_group(props, "stats", "Statistics", OBS_GROUP_NORMAL, stats);
+
     return props;
 }
 
@@ -828,6 +1556,8 @@ void mal_source_register()
     info.get_height = mal_source_get_height;
     info.get_defaults = mal_source_get_defaults;
     info.get_properties = mal_source_get_properties;
+    info.show = mal_source_show;
+    info.hide = mal_source_hide;
     info.video_tick = mal_source_tick;
     info.video_render = mal_source_render;
 
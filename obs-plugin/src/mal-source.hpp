@@ -9,20 +9,34 @@
 #include <atomic>
 #include <string>
 #include "mal-fetcher.hpp"
+#include "list-store.hpp"
+#include "companion-backend.hpp"
+#include "cover-loader.hpp"
+#include "upload-budget.hpp"
+#include "source-stats.hpp"
+#include "text-cache.hpp"
+#include "card-layout.hpp"
 
 struct mal_source {
     obs_source_t *source;
     
     // Settings
+    std::string backend; // list_backend_create name
     std::string username;
+    std::string client_id; // MyAnimeList API backend only
+    std::string endpoint;  // companion server backend only
     std::string status;
     std::string media;
+    std::string first_status; // with status "ALL": fetched and shown first
     int scroll_speed; // pixels per second
     int item_width;
     int item_gap;
     int width;
     int height;
     float text_scale;
+    std::string render_mode; // "cards", "strip" or "direct"
+    bool cover_webp;         // ask the CDN for WebP covers first
+    int cover_px;            // cover width in output pixels: item_width x canvas scale
     
     // Text appearance
     uint32_t title_color;
@@ -33,13 +47,16 @@ struct mal_source {
     uint32_t background_color;
     float background_padding;
     float background_opacity; // 0..1
+
+    // Card geometry derived from the settings above
+    card_layout_params layout;
     
     // Data
-    std::unique_ptr<MALFetcher> fetcher;
-    std::vector<MALEntry> entries;
+    list_snapshot entries; // shared with other sources showing the same list
     std::mutex data_mutex;
 
-    // Deferred GPU frees (must happen on render thread)
+    // Deferred GPU frees (must happen on render thread). Text textures are
+    // owned by the shared text cache and are released rather than destroyed.
     std::vector<gs_image_file_t*> pending_images_free;
     std::vector<gs_texture_t*> pending_textures_free;
 
@@ -48,38 +65,114 @@ struct mal_source {
         gs_image_file_t *image;
         std::string url;
         bool loaded;
-        gs_texture_t *title_tex;
-        uint32_t title_w;
-        uint32_t title_h;
-        gs_texture_t *title2_tex;
-        uint32_t title2_w;
-        uint32_t title2_h;
-        gs_texture_t *title3_tex;
-        uint32_t title3_w;
-        uint32_t title3_h;
-        gs_texture_t *title4_tex;
-        uint32_t title4_w;
-        uint32_t title4_h;
+        cover_handle cover;    // download and decode on the cover workers
+        std::string cover_url; // variant of `url` loaded or being loaded
+        uint32_t cover_failures;  // failed requests in a row
+        uint64_t cover_retry_at;  // no new request before this (os_gettime_ns)
+        gs_texture_t *title_tex[4];
+        uint32_t title_w[4];
+        uint32_t title_h[4];
         gs_texture_t *status_tex;
         uint32_t status_w;
         uint32_t status_h;
+
+        // Display list for this card; rebuilt when its textures or the
+        // layout settings change
+        std::vector<card_op> ops;
+        bool ops_valid;
+
+        // Composited card (render mode "cards"); resident while visible and
+        // for a few cards after it leaves the view
+        card_image card;
+        bool card_valid;
     };
     std::vector<LoadedImage> images;
 
+    // Text for each entry, wrapped and rasterized off the graphics thread
+    // (fetch thread or settings update); parallel to `entries`
+    struct EntryLayout {
+        text_run title[4];
+        text_run status;
+    };
+    std::vector<EntryLayout> layouts;
+
     // Animation
     float scroll_offset;
     uint64_t last_update_time;
     
-    // Cached white texture for backgrounds
+    // Offscreen card targets: cards currently holding one, those in view
+    // first and then the most recently shown, and spare targets kept for
+    // reuse (trimmed on the render thread)
+    std::vector<size_t> resident_cards;
+    std::vector<gs_texrender_t*> card_pool;
+
+    // Strip tiles (render mode "strip"): the ribbon pre-rendered in
+    // fixed-width slices and blitted with a UV offset each frame. Only
+    // tiles in view hold a render target.
+    struct StripTile {
+        gs_texrender_t *render;
+        bool valid;
+    };
+    std::vector<StripTile> strip_tiles;
+    std::vector<size_t> resident_tiles;
+
+    // Shared white texture for backgrounds (reference held on the text cache)
     gs_texture_t *white_texture;
 
-    // Background fetch
+    // Background fetch, or a text relayout, on fetch_thread
     std::atomic<bool> fetching;
+    std::atomic<bool> cancel_fetch; // set on destroy; aborts the fetch in flight
+    std::atomic<int> refs;          // OBS plus a running fetch thread
     std::thread fetch_thread;
 
+    // Push stream of the companion server backend (null for other backends).
+    // While it is connected the source re-reads the list store whenever its
+    // own list is published there, instead of polling on refresh_interval.
+    companion_handle companion;
+    uint64_t seen_publications; // list_store_publications of its key at the last fetch
+
     // Refresh timer
     uint64_t last_fetch_time;
     int refresh_interval; // seconds
+
+    // Settings edits that change the list schedule a refetch here (0 = none);
+    // the tick starts it once the edits settle. Results from an older query
+    // or older text settings are dropped.
+    std::atomic<uint64_t> refetch_at;
+    std::atomic<uint64_t> relayout_at; // same, for edits that only change the text
+    uint64_t fetch_generation;
+    uint64_t text_generation;
+
+    // Visibility: hidden sources pause scrolling and refreshes, and free
+    // their GPU resources after evict_after seconds (0 = never)
+    std::atomic<bool> showing;
+    uint64_t hidden_since;
+    int evict_after;
+    bool gpu_evicted;
+    std::atomic<bool> warm_up_pending;
+
+    // Draws for the current frame, replayed grouped by effect and texture
+    draw_batch batch;
+
+    // Texture uploads: measured costs and the current frame's budget
+    upload_costs upload_cost;
+    upload_budget upload_frame;
+
+    // Render-callback timing, summarized periodically in the log
+    uint64_t render_time_ns;
+    uint64_t render_time_max_ns;
+    uint64_t render_state_changes;
+    uint32_t render_frames;
+    uint64_t last_timing_log;
+
+    // Counters and histograms for the proc handler, the properties panel
+    // and the periodic log; GPU residency is resampled about once a second
+    source_stats stats;
+    uint64_t last_residency_sample;
 };
 
 void mal_source_register();
+
+// Gives fetch threads of destroyed sources a moment to wind down before the
+// module is unloaded.
+void mal_source_wait_for_fetches();
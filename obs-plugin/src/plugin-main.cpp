@@ -1,6 +1,11 @@
 #include <obs-module.h>
 #include <curl/curl.h>
 #include "mal-source.hpp"
+#include "text-cache.hpp"
+#include "list-store.hpp"
+#include "companion-backend.hpp"
+#include "cover-loader.hpp"
+#include "texture-pool.hpp"
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("obs-mal-scroll", "en-US")
@@ -22,6 +27,37 @@ bool obs_module_load(void)
 
 void obs_module_unload(void)
 {
+    mal_source_wait_for_fetches();
+    companion_stop_all();
+    cover_loader_shutdown();
+
+    obs_enter_graphics();
+    texture_pool_clear();
+    obs_leave_graphics();
+
+    text_cache_stats tc = text_cache_get_stats();
+    blog(LOG_INFO, "[MAL] Text cache: %llu hits, %llu misses, %zu live textures",
+         (unsigned long long)tc.hits, (unsigned long long)tc.misses, tc.entries);
+    texture_pool_stats tp = texture_pool_get_stats();
+    blog(LOG_INFO, "[MAL] Texture pool: %llu created, %llu destroyed, %llu reused in place",
+         (unsigned long long)tp.created, (unsigned long long)tp.destroyed, (unsigned long long)tp.reused);
+    list_store_stats ls = list_store_get_stats();
+    blog(LOG_INFO, "[MAL] List store: %llu fetches, %llu shared, %zu lists, %.1f KB received (%.1f KB decompressed)",
+         (unsigned long long)ls.fetches, (unsigned long long)ls.shared, ls.keys, ls.received / 1024.0,
+         ls.decoded / 1024.0);
+    cover_loader_stats cs = cover_loader_get_stats();
+    blog(LOG_INFO, "[MAL] Covers: %llu loaded (%llu from disk cache), %llu failed, %llu WebP variants missing",
+         (unsigned long long)cs.loaded, (unsigned long long)cs.cache_hits, (unsigned long long)cs.failed,
+         (unsigned long long)cs.webp_missing);
+    if (cs.webp > 0) {
+        blog(LOG_INFO, "[MAL] Covers as WebP: %llu, %.1f KB downloaded, %.2f ms average decode",
+             (unsigned long long)cs.webp, cs.webp_bytes / 1024.0, cs.webp_decode_ns / 1e6 / cs.webp);
+    }
+    if (cs.jpeg > 0) {
+        blog(LOG_INFO, "[MAL] Covers as JPEG: %llu, %.1f KB downloaded, %.2f ms average decode",
+             (unsigned long long)cs.jpeg, cs.jpeg_bytes / 1024.0, cs.jpeg_decode_ns / 1e6 / cs.jpeg);
+    }
+
     if (g_curl_initialized) {
         curl_global_cleanup();
         g_curl_initialized = false;
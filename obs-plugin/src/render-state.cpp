@@ -0,0 +1,150 @@
+#include "render-state.hpp"
+#include <graphics/graphics.h>
+#include <util/profiler.h>
+#include <algorithm>
+#include <functional>
+
+static render_state g_state = {};
+
+// Profiler scope per layer, in draw_layer order
+static const char *LAYER_PROFILE_NAMES[] = {
+    "mal_draw_covers",
+    "mal_draw_backgrounds",
+    "mal_draw_text",
+    "mal_draw_premultiplied",
+};
+
+const render_state &render_state_get()
+{
+    gs_effect_t *default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+    gs_effect_t *solid_effect = obs_get_base_effect(OBS_EFFECT_SOLID);
+    if (default_effect == g_state.default_effect && solid_effect == g_state.solid_effect) {
+        return g_state;
+    }
+
+    g_state.default_effect = default_effect;
+    g_state.draw_tech = gs_effect_get_technique(default_effect, "Draw");
+    g_state.image_param = gs_effect_get_param_by_name(default_effect, "image");
+    g_state.solid_effect = solid_effect;
+    g_state.solid_tech = gs_effect_get_technique(solid_effect, "Solid");
+    g_state.color_param = gs_effect_get_param_by_name(solid_effect, "color");
+    return g_state;
+}
+
+static void draw_one(const draw_cmd &cmd, gs_texture_t *tex)
+{
+    gs_matrix_push();
+    gs_matrix_translate3f(cmd.x, cmd.y, 0.0f);
+    if (cmd.layer == draw_layer::premultiplied) {
+        gs_draw_sprite_subregion(tex, 0, cmd.sub_x, 0, cmd.tex_w, cmd.tex_h);
+    } else {
+        gs_matrix_scale3f(cmd.w / cmd.tex_w, cmd.h / cmd.tex_h, 1.0f);
+        gs_draw_sprite(tex, 0, cmd.tex_w, cmd.tex_h);
+    }
+    gs_matrix_pop();
+}
+
+// Sorting can move a draw in front of an earlier one of a higher layer or
+// with another texture. Within a card that is the intended layering; across
+// cards it only changes the picture if the two overlap, e.g. a text
+// background whose padding overhangs the neighbouring card's cover when the
+// gap is smaller than the padding.
+static bool reorder_changes_picture(const draw_cmd &earlier, const draw_cmd &later)
+{
+    if (earlier.card == later.card || earlier.layer < later.layer) return false;
+    if (earlier.layer == later.layer && earlier.tex == later.tex) return false;
+    return earlier.x < later.x + later.w && later.x < earlier.x + earlier.w && earlier.y < later.y + later.h &&
+           later.y < earlier.y + earlier.h;
+}
+
+// Sorts and replays cmds [begin, end) grouped by layer and texture
+static void flush_run(draw_batch &batch, size_t begin, size_t end, const struct vec4 &background_color,
+                      gs_texture_t *white)
+{
+    const render_state &rs = render_state_get();
+
+    // Stable, so draws sharing a layer and texture keep their submission order
+    std::stable_sort(batch.cmds.begin() + begin, batch.cmds.begin() + end,
+                     [](const draw_cmd &a, const draw_cmd &b) {
+                         if (a.layer != b.layer) return a.layer < b.layer;
+                         return std::less<gs_texture_t *>{}(a.tex, b.tex);
+                     });
+
+    size_t i = begin;
+    while (i < end) {
+        const draw_layer layer = batch.cmds[i].layer;
+        size_t layer_end = i;
+        while (layer_end < end && batch.cmds[layer_end].layer == layer) layer_end++;
+        const char *profile_name = LAYER_PROFILE_NAMES[(int)layer];
+        profile_start(profile_name);
+
+        if (layer == draw_layer::background) {
+            if (white && rs.solid_tech && rs.color_param) {
+                gs_effect_set_vec4(rs.color_param, &background_color);
+                gs_technique_begin(rs.solid_tech);
+                gs_technique_begin_pass(rs.solid_tech, 0);
+                batch.state_changes += 2;
+                for (size_t k = i; k < layer_end; k++) {
+                    draw_one(batch.cmds[k], white);
+                }
+                gs_technique_end_pass(rs.solid_tech);
+                gs_technique_end(rs.solid_tech);
+            }
+            profile_end(profile_name);
+            i = layer_end;
+            continue;
+        }
+
+        if (layer == draw_layer::premultiplied) {
+            gs_blend_state_push();
+            gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+        }
+        gs_technique_begin(rs.draw_tech);
+        gs_technique_begin_pass(rs.draw_tech, 0);
+        batch.state_changes++;
+
+        gs_texture_t *bound = nullptr;
+        for (size_t k = i; k < layer_end; k++) {
+            const draw_cmd &cmd = batch.cmds[k];
+            if (!cmd.tex || cmd.tex_w == 0 || cmd.tex_h == 0) continue;
+            if (cmd.tex != bound) {
+                gs_effect_set_texture(rs.image_param, cmd.tex);
+                bound = cmd.tex;
+                batch.state_changes++;
+            }
+            draw_one(cmd, cmd.tex);
+        }
+
+        gs_technique_end_pass(rs.draw_tech);
+        gs_technique_end(rs.draw_tech);
+        if (layer == draw_layer::premultiplied) {
+            gs_blend_state_pop();
+        }
+        profile_end(profile_name);
+        i = layer_end;
+    }
+}
+
+void draw_batch_flush(draw_batch &batch, const struct vec4 &background_color, gs_texture_t *white)
+{
+    batch.state_changes = 0;
+
+    // Cut the frame into runs that can be sorted without changing the
+    // picture; a draw that overlaps an earlier card's draw it could be
+    // sorted in front of starts a new run. Cards lie side by side, so this
+    // is usually one run per frame.
+    size_t begin = 0;
+    for (size_t k = 1; k < batch.cmds.size(); k++) {
+        for (size_t e = begin; e < k; e++) {
+            if (reorder_changes_picture(batch.cmds[e], batch.cmds[k])) {
+                flush_run(batch, begin, k, background_color, white);
+                begin = k;
+                break;
+            }
+        }
+    }
+    if (begin < batch.cmds.size()) flush_run(batch, begin, batch.cmds.size(), background_color, white);
+
+    batch.cmds.clear();
+    batch.cards = 0;
+}
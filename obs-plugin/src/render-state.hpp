@@ -0,0 +1,57 @@
+#pragma once
+
+#include <obs-module.h>
+#include <graphics/vec4.h>
+#include <vector>
+
+// Handles for the base effects the plugin draws with, resolved once per
+// graphics context instead of by name on every draw.
+struct render_state {
+    gs_effect_t *default_effect;
+    gs_technique_t *draw_tech;
+    gs_eparam_t *image_param;
+    gs_effect_t *solid_effect;
+    gs_technique_t *solid_tech;
+    gs_eparam_t *color_param;
+};
+
+// Must be called inside the graphics context. Re-resolves the handles only
+// if the base effects changed (i.e. the graphics context was recreated).
+const render_state &render_state_get();
+
+// Draw layers, replayed in this order. Within a card, the cover lies under
+// the text backgrounds, which lie under the text.
+enum class draw_layer : uint8_t {
+    cover,
+    background,
+    text,
+    premultiplied, // composited cards/strip tiles, blended ONE / INVSRCALPHA
+};
+
+struct draw_cmd {
+    draw_layer layer;
+    gs_texture_t *tex; // nullptr for backgrounds (drawn with the white texture)
+    float x;
+    float y;
+    float w; // on-screen size
+    float h;
+    uint32_t sub_x; // first texel column drawn (premultiplied layer only)
+    uint32_t tex_w; // texel region drawn
+    uint32_t tex_h;
+    uint32_t card;  // draws queued together; see draw_batch_flush
+};
+
+// A frame's draws, collected first and then replayed grouped by layer and
+// texture so each technique is begun once per layer and each texture is
+// bound once per run.
+struct draw_batch {
+    std::vector<draw_cmd> cmds;
+    uint32_t cards = 0;         // card ids handed out since the last flush
+    uint32_t state_changes = 0; // technique begins and param binds in the last flush
+};
+
+// Replays and clears the batch. Must be called inside the graphics context.
+// A card's draws are layered as draw_layer says; draws of different cards
+// that overlap keep their submission order, so a later card paints over an
+// earlier one's overhang just as it would unbatched.
+void draw_batch_flush(draw_batch &batch, const struct vec4 &background_color, gs_texture_t *white);
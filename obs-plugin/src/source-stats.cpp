@@ -0,0 +1,146 @@
+#include "source-stats.hpp"
+#include "texture-pool.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdio>
+
+using json = nlohmann::json;
+
+static int bucket_for(uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+    int k = 0;
+    while (us > 0 && k < stats_histogram::BUCKETS - 1) {
+        us >>= 1;
+        k++;
+    }
+    return k;
+}
+
+void stats_max(std::atomic<uint64_t> &target, uint64_t value)
+{
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void stats_histogram_record(stats_histogram &h, uint64_t ns)
+{
+    h.buckets[bucket_for(ns)].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    stats_max(h.max_ns, ns);
+}
+
+double stats_histogram_quantile_us(const stats_histogram &h, double q)
+{
+    uint64_t counts[stats_histogram::BUCKETS];
+    uint64_t total = 0;
+    for (int k = 0; k < stats_histogram::BUCKETS; k++) {
+        counts[k] = h.buckets[k].load(std::memory_order_relaxed);
+        total += counts[k];
+    }
+    if (total == 0) return 0.0;
+
+    const double max_us = h.max_ns.load(std::memory_order_relaxed) / 1000.0;
+    uint64_t rank = (uint64_t)(q * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int k = 0; k < stats_histogram::BUCKETS - 1; k++) {
+        seen += counts[k];
+        if (seen >= rank) return std::min((double)(1ULL << k), max_us);
+    }
+    return max_us;
+}
+
+void source_stats_frame(source_stats &s, uint64_t render_ns, uint32_t uploads, uint32_t deferred,
+                        uint64_t state_changes)
+{
+    s.frames.fetch_add(1, std::memory_order_relaxed);
+    s.uploads.fetch_add(uploads, std::memory_order_relaxed);
+    s.deferred_uploads.fetch_add(deferred, std::memory_order_relaxed);
+    stats_max(s.max_uploads_per_frame, uploads);
+    s.state_changes.fetch_add(state_changes, std::memory_order_relaxed);
+    stats_histogram_record(s.render_time, render_ns);
+}
+
+static double average_us(const stats_histogram &h)
+{
+    uint64_t count = h.count.load(std::memory_order_relaxed);
+    return count ? h.total_ns.load(std::memory_order_relaxed) / 1000.0 / count : 0.0;
+}
+
+std::string source_stats_describe(const source_stats &s, const char *separator)
+{
+    const uint64_t frames = s.frames.load(std::memory_order_relaxed);
+    const double uploads_per_frame = frames ? (double)s.uploads.load(std::memory_order_relaxed) / frames : 0.0;
+    const double changes_per_frame =
+        frames ? (double)s.state_changes.load(std::memory_order_relaxed) / frames : 0.0;
+    const texture_pool_stats tp = texture_pool_get_stats();
+    char buf[1024];
+    snprintf(buf, sizeof(buf),
+             "Fetch: %llu, p50 %.0f ms, p95 %.0f ms, %.1f KB received (%.1f KB decompressed), "
+             "%llu entries%s"
+             "Parse: p50 %.1f ms, p95 %.1f ms%s"
+             "Render: %llu frames, avg %.0f us, p95 %.0f us, p99 %.0f us, %.1f state changes/frame%s"
+             "Uploads: %.2f/frame, max %llu, %llu deferred%s"
+             "GPU: %llu textures, %.1f MB%s"
+             "Texture pool: %llu created, %llu destroyed, %llu reused, %zu spare (%.1f MB)",
+             (unsigned long long)s.fetches.load(std::memory_order_relaxed),
+             stats_histogram_quantile_us(s.fetch_latency, 0.5) / 1000.0,
+             stats_histogram_quantile_us(s.fetch_latency, 0.95) / 1000.0,
+             s.bytes_received.load(std::memory_order_relaxed) / 1024.0,
+             s.bytes_decoded.load(std::memory_order_relaxed) / 1024.0,
+             (unsigned long long)s.entries.load(std::memory_order_relaxed), separator,
+             stats_histogram_quantile_us(s.parse_time, 0.5) / 1000.0,
+             stats_histogram_quantile_us(s.parse_time, 0.95) / 1000.0, separator, (unsigned long long)frames,
+             average_us(s.render_time), stats_histogram_quantile_us(s.render_time, 0.95),
+             stats_histogram_quantile_us(s.render_time, 0.99), changes_per_frame, separator, uploads_per_frame,
+             (unsigned long long)s.max_uploads_per_frame.load(std::memory_order_relaxed),
+             (unsigned long long)s.deferred_uploads.load(std::memory_order_relaxed), separator,
+             (unsigned long long)s.resident_textures.load(std::memory_order_relaxed),
+             s.vram_bytes.load(std::memory_order_relaxed) / (1024.0 * 1024.0), separator,
+             (unsigned long long)tp.created, (unsigned long long)tp.destroyed, (unsigned long long)tp.reused,
+             tp.pooled, tp.pooled_bytes / (1024.0 * 1024.0));
+    return buf;
+}
+
+static json histogram_json(const stats_histogram &h)
+{
+    return json{
+        {"count", h.count.load(std::memory_order_relaxed)},
+        {"avg_us", average_us(h)},
+        {"p50_us", stats_histogram_quantile_us(h, 0.5)},
+        {"p95_us", stats_histogram_quantile_us(h, 0.95)},
+        {"p99_us", stats_histogram_quantile_us(h, 0.99)},
+        {"max_us", h.max_ns.load(std::memory_order_relaxed) / 1000.0},
+    };
+}
+
+std::string source_stats_json(const source_stats &s)
+{
+    json j = {
+        {"fetches", s.fetches.load(std::memory_order_relaxed)},
+        {"bytes_received", s.bytes_received.load(std::memory_order_relaxed)},
+        {"bytes_decoded", s.bytes_decoded.load(std::memory_order_relaxed)},
+        {"entries", s.entries.load(std::memory_order_relaxed)},
+        {"fetch_latency", histogram_json(s.fetch_latency)},
+        {"parse_time", histogram_json(s.parse_time)},
+        {"frames", s.frames.load(std::memory_order_relaxed)},
+        {"uploads", s.uploads.load(std::memory_order_relaxed)},
+        {"deferred_uploads", s.deferred_uploads.load(std::memory_order_relaxed)},
+        {"max_uploads_per_frame", s.max_uploads_per_frame.load(std::memory_order_relaxed)},
+        {"state_changes", s.state_changes.load(std::memory_order_relaxed)},
+        {"resident_textures", s.resident_textures.load(std::memory_order_relaxed)},
+        {"vram_bytes", s.vram_bytes.load(std::memory_order_relaxed)},
+        {"render_time", histogram_json(s.render_time)},
+    };
+    const texture_pool_stats tp = texture_pool_get_stats();
+    j["texture_pool"] = json{
+        {"created", tp.created},
+        {"destroyed", tp.destroyed},
+        {"reused", tp.reused},
+        {"pooled", tp.pooled},
+        {"pooled_bytes", tp.pooled_bytes},
+    };
+    return j.dump();
+}
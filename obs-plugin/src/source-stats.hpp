@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Per-source counters and latency histograms. Fetch threads and the
+// graphics thread write to them without taking a lock (relaxed atomics),
+// and readers (the proc handler, the properties panel, the periodic log)
+// take a consistent-enough snapshot at any time. Values accumulate for the
+// life of the source.
+
+// Latency histogram with power-of-two buckets: bucket 0 counts samples
+// under 1 us, bucket k samples in [2^(k-1), 2^k) us; the last one takes
+// everything slower (above ~4 s).
+struct stats_histogram {
+    static const int BUCKETS = 24;
+    std::atomic<uint64_t> buckets[BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+};
+
+void stats_histogram_record(stats_histogram &h, uint64_t ns);
+
+// Upper bound, in microseconds, of the bucket holding quantile q (0..1);
+// 0 with no samples
+double stats_histogram_quantile_us(const stats_histogram &h, double q);
+
+struct source_stats {
+    // Written by the fetch thread
+    std::atomic<uint64_t> fetches{0};
+    std::atomic<uint64_t> bytes_received{0}; // on the wire, by this source's own fetches
+    std::atomic<uint64_t> bytes_decoded{0};  // the same bytes decompressed
+    std::atomic<uint64_t> entries{0};        // in the last list
+    stats_histogram fetch_latency;           // list_store_get, shared fetches included
+    stats_histogram parse_time;              // fetched list to laid-out, rasterized text
+
+    // Written by the graphics thread
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> uploads{0};
+    std::atomic<uint64_t> deferred_uploads{0}; // refused by the frame's upload budget
+    std::atomic<uint64_t> max_uploads_per_frame{0};
+    std::atomic<uint64_t> state_changes{0}; // technique begins and binds in draw_batch_flush
+    std::atomic<uint64_t> resident_textures{0}; // covers, text and render targets held
+    std::atomic<uint64_t> vram_bytes{0};        // their estimated size
+    stats_histogram render_time;
+};
+
+// Raises `target` to `value` if it is lower
+void stats_max(std::atomic<uint64_t> &target, uint64_t value);
+
+// Records one rendered frame, the uploads it made and its state changes
+void source_stats_frame(source_stats &s, uint64_t render_ns, uint32_t uploads, uint32_t deferred,
+                        uint64_t state_changes);
+
+// Human-readable summary, one line per area joined by `separator`. The
+// summary and the JSON also carry the module-wide texture pool counters.
+std::string source_stats_describe(const source_stats &s, const char *separator);
+
+// The whole block as a JSON object, histograms as count/avg/p50/p95/p99/max
+std::string source_stats_json(const source_stats &s);
@@ -0,0 +1,130 @@
+#include "text-cache.hpp"
+#include <cctype>
+#include <mutex>
+#include <unordered_map>
+#include "font5x7.hpp"
+#include "texture-pool.hpp"
+
+// Font parameters are part of the key so a future font or glyph size
+// never aliases the 5x7 entries.
+enum : uint8_t {
+    FONT_ID_5X7 = 1,
+    FONT_ID_SOLID = 0xFF,
+};
+
+struct TextCacheEntry {
+    gs_texture_t *tex;
+    uint32_t w;
+    uint32_t h;
+    uint32_t refs;
+};
+
+static std::mutex g_mutex;
+static std::unordered_map<std::string, TextCacheEntry> g_entries;
+static std::unordered_map<gs_texture_t*, std::string> g_keys;
+static uint64_t g_hits = 0;
+static uint64_t g_misses = 0;
+
+static std::string make_key(uint8_t font_id, uint32_t rgba, const std::string &text)
+{
+    std::string key;
+    key.reserve(text.size() + 6);
+    key.push_back((char)font_id);
+    key.push_back((char)((rgba >> 24) & 0xFF));
+    key.push_back((char)((rgba >> 16) & 0xFF));
+    key.push_back((char)((rgba >> 8) & 0xFF));
+    key.push_back((char)(rgba & 0xFF));
+    // The bitmap font only has upper-case glyphs, so case never matters
+    for (char c : text) key.push_back((char)std::toupper((unsigned char)c));
+    return key;
+}
+
+static gs_texture_t *insert_locked(const std::string &key, gs_texture_t *tex, uint32_t w, uint32_t h)
+{
+    g_entries[key] = TextCacheEntry{tex, w, h, 1};
+    g_keys[tex] = key;
+    return tex;
+}
+
+void text_run_rasterize(text_run &run)
+{
+    if (run.text.empty()) {
+        run.pixels.clear();
+        run.w = run.h = 0;
+        return;
+    }
+    font5x7_render(run.text, run.rgba, run.pixels, run.w, run.h);
+}
+
+gs_texture_t *text_cache_acquire(text_run &run, uint32_t &w, uint32_t &h)
+{
+    if (run.text.empty()) return nullptr;
+
+    std::string key = make_key(FONT_ID_5X7, run.rgba, run.text);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_entries.find(key);
+    if (it != g_entries.end()) {
+        g_hits++;
+        it->second.refs++;
+        w = it->second.w;
+        h = it->second.h;
+        std::vector<uint8_t>().swap(run.pixels);
+        return it->second.tex;
+    }
+
+    g_misses++;
+    if (run.pixels.empty()) text_run_rasterize(run);
+    if (run.pixels.empty() || run.w == 0 || run.h == 0) return nullptr;
+    gs_texture_t *tex = texture_pool_acquire(run.w, run.h, GS_RGBA, run.pixels.data());
+    if (!tex) return nullptr;
+    w = run.w;
+    h = run.h;
+    std::vector<uint8_t>().swap(run.pixels);
+    return insert_locked(key, tex, w, h);
+}
+
+gs_texture_t *text_cache_acquire_white()
+{
+    std::string key = make_key(FONT_ID_SOLID, 0xFFFFFFFF, "");
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_entries.find(key);
+    if (it != g_entries.end()) {
+        g_hits++;
+        it->second.refs++;
+        return it->second.tex;
+    }
+
+    g_misses++;
+    uint32_t white_pixel = 0xFFFFFFFF;
+    gs_texture_t *tex = texture_pool_acquire(1, 1, GS_RGBA, (const uint8_t*)&white_pixel);
+    if (!tex) return nullptr;
+    return insert_locked(key, tex, 1, 1);
+}
+
+void text_cache_release(gs_texture_t *tex)
+{
+    if (!tex) return;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto key_it = g_keys.find(tex);
+    if (key_it == g_keys.end()) {
+        // Not ours; keep the old ownership semantics and free it directly
+        gs_texture_destroy(tex);
+        return;
+    }
+
+    auto it = g_entries.find(key_it->second);
+    if (it != g_entries.end() && --it->second.refs > 0) return;
+
+    if (it != g_entries.end()) g_entries.erase(it);
+    g_keys.erase(key_it);
+    texture_pool_release(tex);
+}
+
+text_cache_stats text_cache_get_stats()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return text_cache_stats{g_hits, g_misses, g_entries.size()};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <obs-module.h>
+#include <string>
+#include <cstdint>
+#include <vector>
+
+// Module-wide, ref-counted cache of rasterized text textures.
+// Identical labels (status badges, repeated titles) and the solid white
+// texture used for backgrounds are shared by every mal_source instead of
+// being created per entry. All calls must be made inside the graphics context.
+
+// A line of text laid out and rasterized off the graphics thread. The render
+// thread only hands it to text_cache_acquire, which uploads the pixels on a
+// cache miss and drops them once they live on the GPU.
+struct text_run {
+    std::string text;
+    uint32_t rgba = 0;
+    std::vector<uint8_t> pixels;
+    uint32_t w = 0;
+    uint32_t h = 0;
+};
+
+// Rasterizes run.text with the 5x7 font into run.pixels (any thread).
+void text_run_rasterize(text_run &run);
+
+struct text_cache_stats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t entries;
+};
+
+// Returns a texture for the run and adds a reference to it. On a miss the
+// run's pre-rasterized pixels are uploaded (and rasterized here only if the
+// caller did not). Width/height are written to w/h. Returns nullptr for
+// empty text or if texture creation failed.
+gs_texture_t *text_cache_acquire(text_run &run, uint32_t &w, uint32_t &h);
+
+// Returns the shared 1x1 white texture (ref-counted like text textures).
+gs_texture_t *text_cache_acquire_white();
+
+// Drops one reference; the texture goes back to the texture pool
+// (texture-pool.hpp) when the last one goes away.
+void text_cache_release(gs_texture_t *tex);
+
+text_cache_stats text_cache_get_stats();
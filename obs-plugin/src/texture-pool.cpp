@@ -0,0 +1,110 @@
+#include "texture-pool.hpp"
+#include <mutex>
+#include <vector>
+
+// Bytes of spare textures kept at most. Requests only match an exact size,
+// so the pool has to hold a whole relayout's worth of labels to help: a card
+// has up to five of about 16 KB, and 4 MB covers some fifty cards, the
+// cards in a 1920 px view plus the upload lookahead several times over.
+static const uint64_t MAX_POOLED_BYTES = 4 * 1024 * 1024;
+
+struct PooledTexture {
+    gs_texture_t *tex;
+    uint32_t w;
+    uint32_t h;
+    enum gs_color_format format;
+    uint64_t bytes;
+};
+
+static std::mutex g_mutex;
+static std::vector<PooledTexture> g_spare; // oldest first
+static uint64_t g_spare_bytes = 0;
+static uint64_t g_created = 0;
+static uint64_t g_destroyed = 0;
+static uint64_t g_reused = 0;
+
+static uint32_t bytes_per_pixel(enum gs_color_format format)
+{
+    return format == GS_RGBA || format == GS_BGRA ? 4 : 0;
+}
+
+gs_texture_t *texture_pool_acquire(uint32_t w, uint32_t h, enum gs_color_format format, const uint8_t *data)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        // Newest first: the most recently released is the likeliest still resident
+        for (size_t i = g_spare.size(); i-- > 0;) {
+            const PooledTexture &p = g_spare[i];
+            if (p.w != w || p.h != h || p.format != format) continue;
+            gs_texture_t *tex = p.tex;
+            g_spare_bytes -= p.bytes;
+            g_spare.erase(g_spare.begin() + i);
+            g_reused++;
+            gs_texture_set_image(tex, data, w * bytes_per_pixel(format), false);
+            return tex;
+        }
+    }
+
+    const uint8_t *level_data[1] = {data};
+    gs_texture_t *tex = gs_texture_create(w, h, format, 1, level_data, GS_DYNAMIC);
+    if (tex) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_created++;
+    }
+    return tex;
+}
+
+void texture_pool_release(gs_texture_t *tex)
+{
+    if (!tex) return;
+
+    // Only formats whose row size is known can be refilled in place
+    enum gs_color_format format = gs_texture_get_color_format(tex);
+    if (bytes_per_pixel(format) == 0) {
+        gs_texture_destroy(tex);
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_destroyed++;
+        return;
+    }
+
+    uint32_t w = gs_texture_get_width(tex);
+    uint32_t h = gs_texture_get_height(tex);
+    uint64_t bytes = (uint64_t)w * h * bytes_per_pixel(format);
+    std::vector<gs_texture_t *> evicted;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_spare.push_back(PooledTexture{tex, w, h, format, bytes});
+        g_spare_bytes += bytes;
+        size_t n = 0;
+        while (g_spare_bytes > MAX_POOLED_BYTES && n < g_spare.size()) {
+            evicted.push_back(g_spare[n].tex);
+            g_spare_bytes -= g_spare[n].bytes;
+            n++;
+        }
+        g_spare.erase(g_spare.begin(), g_spare.begin() + n);
+        g_destroyed += n;
+    }
+    for (gs_texture_t *old : evicted) {
+        gs_texture_destroy(old);
+    }
+}
+
+void texture_pool_clear()
+{
+    std::vector<PooledTexture> spare;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        spare.swap(g_spare);
+        g_spare_bytes = 0;
+        g_destroyed += spare.size();
+    }
+    for (auto &p : spare) {
+        gs_texture_destroy(p.tex);
+    }
+}
+
+texture_pool_stats texture_pool_get_stats()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return texture_pool_stats{g_created, g_destroyed, g_reused, g_spare.size(), g_spare_bytes};
+}
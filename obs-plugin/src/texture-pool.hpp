@@ -0,0 +1,33 @@
+#pragma once
+
+#include <obs-module.h>
+#include <cstdint>
+
+// Module-wide pool of spare dynamic textures, bucketed by size and format.
+// A texture whose last user lets go is kept here instead of being
+// destroyed, and a later request for the same size and format gets it back
+// with its pixels replaced in place (gs_texture_set_image). Text textures
+// rebuilt after a settings edit or a list refresh mostly keep their
+// dimensions, so they stop costing a driver allocation each.
+// All calls must be made inside the graphics context.
+
+struct texture_pool_stats {
+    uint64_t created;   // gs_texture_create calls
+    uint64_t destroyed; // gs_texture_destroy calls
+    uint64_t reused;    // requests served from the pool
+    size_t pooled;      // spare textures held right now
+    uint64_t pooled_bytes;
+};
+
+// Returns a dynamic w x h texture holding `data` (tightly packed rows),
+// reused from the pool when one of that size and format is spare.
+gs_texture_t *texture_pool_acquire(uint32_t w, uint32_t h, enum gs_color_format format, const uint8_t *data);
+
+// Hands a texture from texture_pool_acquire back; the oldest spare
+// textures are destroyed once the pool holds more than a few MB.
+void texture_pool_release(gs_texture_t *tex);
+
+// Destroys every spare texture.
+void texture_pool_clear();
+
+texture_pool_stats texture_pool_get_stats();
@@ -0,0 +1,43 @@
+#include "upload-budget.hpp"
+#include <algorithm>
+#include <obs-module.h>
+
+// Share of the frame interval one source may spend uploading, and bounds
+// for very high or very low frame rates
+static const double FRAME_SHARE = 0.1;
+static const uint64_t MIN_BUDGET_NS = 500000;  // 0.5 ms
+static const uint64_t MAX_BUDGET_NS = 4000000; // 4 ms
+
+// Weight of the newest measurement in the running cost estimate
+static const double COST_SMOOTHING = 0.2;
+
+void upload_budget_begin(upload_budget &budget, upload_costs &costs)
+{
+    uint64_t interval_ns = 1000000000ULL / 60;
+    struct obs_video_info ovi;
+    if (obs_get_video_info(&ovi) && ovi.fps_num > 0) {
+        interval_ns = (uint64_t)ovi.fps_den * 1000000000ULL / ovi.fps_num;
+    }
+
+    budget.budget_ns = std::min(MAX_BUDGET_NS, std::max(MIN_BUDGET_NS, (uint64_t)(interval_ns * FRAME_SHARE)));
+    budget.spent_ns = 0;
+    budget.uploads = 0;
+    budget.deferred = 0;
+    budget.costs = &costs;
+}
+
+bool upload_budget_allows(upload_budget &budget, upload_kind kind)
+{
+    if (budget.uploads == 0) return true;
+    if (budget.spent_ns + budget.costs->ns[(int)kind] <= budget.budget_ns) return true;
+    budget.deferred++;
+    return false;
+}
+
+void upload_budget_spend(upload_budget &budget, upload_kind kind, uint64_t elapsed_ns)
+{
+    budget.spent_ns += elapsed_ns;
+    budget.uploads++;
+    double &cost = budget.costs->ns[(int)kind];
+    cost += (elapsed_ns - cost) * COST_SMOOTHING;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+// Time budget for texture uploads (covers, text) on the graphics thread.
+//
+// Each frame a source may spend a share of the frame interval on uploads;
+// the share follows the output frame rate (obs_get_video_info), so 30 fps
+// allows more per frame than 144 fps. Upload costs are measured as they
+// happen and averaged, and an upload is only started if its expected cost
+// still fits. The first upload of a frame always goes ahead, so loading
+// makes progress whatever the estimates say.
+
+enum class upload_kind {
+    cover,
+    text,
+    count,
+};
+
+// Running cost estimates; one per source, kept across frames
+struct upload_costs {
+    double ns[(int)upload_kind::count] = {2000000.0, 200000.0};
+};
+
+struct upload_budget {
+    uint64_t budget_ns = 0;
+    uint64_t spent_ns = 0;
+    uint32_t uploads = 0;  // this frame
+    uint32_t deferred = 0; // refused this frame for lack of time
+    upload_costs *costs = nullptr;
+};
+
+// Starts a frame's budget
+void upload_budget_begin(upload_budget &budget, upload_costs &costs);
+
+// True if an upload of `kind` may start now; counts it as deferred if not
+bool upload_budget_allows(upload_budget &budget, upload_kind kind);
+
+// Records an upload that took elapsed_ns
+void upload_budget_spend(upload_budget &budget, upload_kind kind, uint64_t elapsed_ns);
@@ -0,0 +1,221 @@
+// Card display-list building, specialized against generic, on a stubbed
+// graphics backend (stub-graphics.cpp; no OBS, no GPU):
+//
+//   build/tools/card-bench
+//
+// card_layout_build dispatches once to a builder instantiated for the
+// text-background and cover flags. The generic builder below is the one it
+// replaced, which tested both flags inside the body. For every flag
+// combination the two must produce the same ops; the timings cover building
+// the visible cards' display lists and replaying them through
+// draw_batch_flush, as a frame that rebuilds every card would. It also checks
+// that the flush keeps cards that overlap in submission order.
+
+#include "card-layout.hpp"
+#include "stub-graphics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static const int CARDS = 10; // visible at 1920 px with 200 px cards
+static const int FRAMES = 50000;
+
+// Before card_layout_specialize: one body, flags tested at run time
+static void build_generic(const card_layout_params &params, const card_textures &textures,
+                          std::vector<card_op> &ops)
+{
+    ops.clear();
+
+    const float pad = params.background_padding;
+    float avail = params.item_width - 12.0f - (params.text_background ? pad * 2.0f : 0.0f);
+    if (avail < 1.0f) avail = 1.0f;
+
+    auto push_text = [&](gs_texture_t *tex, uint32_t tw, uint32_t th, float x, float y, float scale) {
+        if (!tex || tw == 0 || th == 0 || scale <= 0.0f) return;
+        float w = tw * scale;
+        float h = th * scale;
+        if (params.text_background) {
+            ops.push_back(card_op{draw_layer::background, x - pad, y - pad,
+                                  w + pad * 2.0f, h + pad * 2.0f, nullptr, 1, 1});
+        }
+        ops.push_back(card_op{draw_layer::text, x, y, w, h, tex, tw, th});
+    };
+
+    float scaled_height = 0.0f;
+    if (textures.cover) {
+        uint32_t img_width = gs_texture_get_width(textures.cover);
+        uint32_t img_height = gs_texture_get_height(textures.cover);
+        if (img_width > 0 && img_height > 0) {
+            float scale = params.item_width / img_width;
+            scaled_height = img_height * scale;
+            ops.push_back(card_op{draw_layer::cover, 0.0f, 0.0f, params.item_width, scaled_height,
+                                  textures.cover, img_width, img_height});
+        }
+    }
+
+    if (textures.status && textures.status_w > 0) {
+        float badge_scale = std::max(1.5f, std::min(3.0f, std::min(params.text_scale, avail / (float)textures.status_w)));
+        push_text(textures.status, textures.status_w, textures.status_h, 6.0f, 6.0f, badge_scale);
+    }
+
+    if (scaled_height > 0.0f && textures.title[0]) {
+        const float line_spacing = 4.0f;
+        float y = scaled_height + 8.0f;
+        for (int i = 0; i < 4; i++) {
+            uint32_t tw = textures.title_w[i];
+            uint32_t th = textures.title_h[i];
+            if (!textures.title[i] || tw == 0 || th == 0) continue;
+            float scale = std::min(3.0f, std::min(params.text_scale, avail / (float)tw));
+            push_text(textures.title[i], tw, th, 6.0f, y, scale);
+            y += th * scale + line_spacing;
+        }
+    }
+}
+
+using build_fn = void (*)(const card_layout_params &, const card_textures &, std::vector<card_op> &);
+
+static bool same_ops(const std::vector<card_op> &a, const std::vector<card_op> &b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].kind != b[i].kind || a[i].tex != b[i].tex || a[i].x != b[i].x || a[i].y != b[i].y ||
+            a[i].w != b[i].w || a[i].h != b[i].h || a[i].tex_w != b[i].tex_w || a[i].tex_h != b[i].tex_h)
+            return false;
+    }
+    return true;
+}
+
+struct frame_cost {
+    double build_ns; // per frame, all visible cards
+    double flush_ns;
+};
+
+static frame_cost time_frames(build_fn build, const card_layout_params &params,
+                              const std::vector<card_textures> &cards, gs_texture_t *white)
+{
+    std::vector<std::vector<card_op>> ops(cards.size());
+    draw_batch batch;
+    struct vec4 color = {};
+    std::chrono::steady_clock::duration build_time{};
+    std::chrono::steady_clock::duration flush_time{};
+
+    for (int f = 0; f < FRAMES; f++) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < cards.size(); i++) build(params, cards[i], ops[i]);
+        auto built = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < cards.size(); i++) card_queue(ops[i], i * params.pitch, batch);
+        draw_batch_flush(batch, color, white);
+        auto flushed = std::chrono::steady_clock::now();
+        build_time += built - start;
+        flush_time += flushed - built;
+    }
+
+    return frame_cost{std::chrono::duration<double, std::nano>(build_time).count() / FRAMES,
+                      std::chrono::duration<double, std::nano>(flush_time).count() / FRAMES};
+}
+
+// Card A's badge background overhangs into card B, which is queued after
+// it: B's cover must still be drawn over it, as it would be unbatched. With
+// a gap between the cards the whole frame stays one sorted run.
+static bool overlap_keeps_order(gs_texture_t *white, gs_texture_t *cover, gs_texture_t *text)
+{
+    std::vector<card_op> ops = {
+        card_op{draw_layer::cover, 0.0f, 0.0f, 200.0f, 284.0f, cover, 225, 320},
+        card_op{draw_layer::background, 150.0f, 2.0f, 60.0f, 28.0f, nullptr, 1, 1},
+        card_op{draw_layer::text, 154.0f, 6.0f, 52.0f, 20.0f, text, 52, 20},
+    };
+    struct vec4 color = {};
+    std::vector<gs_texture_t *> trace;
+    stub_draw_trace = &trace;
+
+    draw_batch batch;
+    card_queue(ops, 0.0f, batch);
+    card_queue(ops, 200.0f, batch);
+    draw_batch_flush(batch, color, white);
+    // A: cover, background, text; then B the same
+    bool ordered = trace.size() == 6 && trace[1] == white && trace[3] == cover;
+
+    trace.clear();
+    uint64_t begins = stub_graphics.technique_begins;
+    card_queue(ops, 0.0f, batch);
+    card_queue(ops, 220.0f, batch);
+    draw_batch_flush(batch, color, white);
+    // One technique per layer, covers first
+    bool batched = stub_graphics.technique_begins - begins == 3 && trace.size() == 6 && trace[0] == cover &&
+                   trace[1] == cover;
+
+    stub_draw_trace = nullptr;
+    return ordered && batched;
+}
+
+int main()
+{
+    gs_texture_t *white = stub_texture_create(1, 1);
+    gs_texture_t *status = stub_texture_create(64, 16);
+    std::vector<gs_texture_t *> textures = {white, status};
+
+    // A mix of cards: most with a cover and a two-line title, some still
+    // waiting for their cover
+    std::vector<card_textures> cards(CARDS);
+    for (int i = 0; i < CARDS; i++) {
+        card_textures &c = cards[i];
+        c = {};
+        if (i % 4 != 3) {
+            c.cover = stub_texture_create(225, 320);
+            textures.push_back(c.cover);
+        }
+        for (int line = 0; line < 2; line++) {
+            c.title[line] = stub_texture_create(180 + line * 7, 18);
+            c.title_w[line] = 180 + line * 7;
+            c.title_h[line] = 18;
+            textures.push_back(c.title[line]);
+        }
+        c.status = status;
+        c.status_w = 64;
+        c.status_h = 16;
+    }
+
+    int failed = 0;
+    if (!overlap_keeps_order(white, cards[0].cover, status)) {
+        printf("FAIL overlapping cards are not drawn in submission order\n");
+        failed++;
+    }
+
+    printf("%-15s %-10s %12s %12s %12s\n", "text background", "builder", "build ns", "flush ns", "ops/frame");
+    for (int background = 0; background < 2; background++) {
+        card_layout_params params = {};
+        params.item_width = 200.0f;
+        params.pitch = 210.0f;
+        params.text_scale = 1.0f;
+        params.text_background = background != 0;
+        params.background_padding = 4.0f;
+        card_layout_specialize(params);
+
+        size_t op_count = 0;
+        for (const auto &c : cards) {
+            std::vector<card_op> specialized, generic;
+            card_layout_build(params, c, specialized);
+            build_generic(params, c, generic);
+            if (!same_ops(specialized, generic)) {
+                printf("FAIL text background %s: specialized and generic ops differ\n", background ? "on" : "off");
+                failed++;
+            }
+            op_count += specialized.size();
+        }
+
+        frame_cost spec = time_frames(card_layout_build, params, cards, white);
+        frame_cost gen = time_frames(build_generic, params, cards, white);
+        printf("%-15s %-10s %12.1f %12.1f %12zu\n", background ? "on" : "off", "special", spec.build_ns,
+               spec.flush_ns, op_count);
+        printf("%-15s %-10s %12.1f %12.1f %12zu\n", background ? "on" : "off", "generic", gen.build_ns,
+               gen.flush_ns, op_count);
+    }
+
+    printf("stub backend: %llu draws, %llu technique begins, %llu texture binds\n",
+           (unsigned long long)stub_graphics.draws, (unsigned long long)stub_graphics.technique_begins,
+           (unsigned long long)stub_graphics.texture_binds);
+
+    for (gs_texture_t *tex : textures) stub_texture_destroy(tex);
+    return failed == 0 ? 0 : 1;
+}
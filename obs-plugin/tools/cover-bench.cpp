@@ -0,0 +1,139 @@
+// Cover size and decode time, WebP against JPEG, through the same decoder
+// the cover loader uses (gs_image_file_init):
+//
+//   build/tools/cover-bench ../replay-fixtures/covers [file or directory ...]
+//
+// The fixtures are synthetic 225x320 covers saved as JPEG (quality 90) and
+// WebP (quality 80). Pass the plugin's covers/ cache directory to measure
+// real CDN covers instead. Covers that share a name in both formats are
+// also compared pairwise. Fails if any cover does not decode.
+
+#include <graphics/image-file.h>
+#include <util/platform.h>
+#include <cctype>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const int DECODES = 50; // per cover; the mean is reported
+
+struct cover_result {
+    std::string name; // file name without extension
+    bool webp;
+    uint64_t bytes;
+    double decode_us;
+};
+
+struct format_totals {
+    int covers = 0;
+    uint64_t bytes = 0;
+    double decode_us = 0.0;
+};
+
+static bool is_cover(const fs::path &path, bool *webp)
+{
+    std::string ext = path.extension().u8string();
+    for (auto &c : ext) c = (char)tolower((unsigned char)c);
+    *webp = ext == ".webp";
+    return *webp || ext == ".jpg" || ext == ".jpeg";
+}
+
+static void collect(const fs::path &path, std::vector<fs::path> &files)
+{
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (fs::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+            bool webp;
+            if (it->is_regular_file(ec) && is_cover(it->path(), &webp)) files.push_back(it->path());
+        }
+    } else {
+        files.push_back(path);
+    }
+}
+
+// Mean decode time in microseconds, or a negative value if it fails
+static double time_decode(const std::string &path, uint32_t *cx, uint32_t *cy)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < DECODES; i++) {
+        gs_image_file_t image = {};
+        uint64_t start = os_gettime_ns();
+        gs_image_file_init(&image, path.c_str());
+        total += os_gettime_ns() - start;
+        bool loaded = image.loaded;
+        *cx = image.cx;
+        *cy = image.cy;
+        gs_image_file_free(&image);
+        if (!loaded) return -1.0;
+    }
+    return total / 1000.0 / DECODES;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <cover file or directory> ...\n", argv[0]);
+        return 2;
+    }
+    std::vector<fs::path> files;
+    for (int i = 1; i < argc; i++) collect(fs::u8path(argv[i]), files);
+    std::sort(files.begin(), files.end());
+
+    int failed = 0;
+    std::vector<cover_result> results;
+    printf("%-24s %-5s %9s %10s %12s\n", "cover", "type", "pixels", "bytes", "decode us");
+    for (const auto &path : files) {
+        bool webp;
+        if (!is_cover(path, &webp)) continue;
+        std::error_code ec;
+        uint64_t bytes = fs::file_size(path, ec);
+        uint32_t cx = 0, cy = 0;
+        double us = time_decode(path.u8string(), &cx, &cy);
+        std::string name = path.stem().u8string();
+        if (us < 0.0 || ec) {
+            printf("FAIL %s does not decode\n", path.u8string().c_str());
+            failed++;
+            continue;
+        }
+        char pixels[32];
+        snprintf(pixels, sizeof(pixels), "%ux%u", cx, cy);
+        printf("%-24s %-5s %9s %10llu %12.1f\n", name.c_str(), webp ? "webp" : "jpeg", pixels,
+               (unsigned long long)bytes, us);
+        results.push_back({name, webp, bytes, us});
+    }
+
+    if (results.empty()) {
+        printf("FAIL no covers found\n");
+        return 1;
+    }
+
+    // Totals per format, and the same covers side by side
+    format_totals jpeg, webp;
+    std::map<std::string, const cover_result *> jpeg_by_name;
+    for (const auto &r : results) {
+        format_totals &t = r.webp ? webp : jpeg;
+        t.covers++;
+        t.bytes += r.bytes;
+        t.decode_us += r.decode_us;
+        if (!r.webp) jpeg_by_name[r.name] = &r;
+    }
+    for (const auto &t : {std::make_pair("jpeg", jpeg), std::make_pair("webp", webp)}) {
+        if (t.second.covers == 0) continue;
+        printf("%s: %d covers, mean %.1f KB, mean decode %.1f us\n", t.first, t.second.covers,
+               t.second.bytes / 1024.0 / t.second.covers, t.second.decode_us / t.second.covers);
+    }
+    for (const auto &r : results) {
+        auto it = jpeg_by_name.find(r.name);
+        if (!r.webp || it == jpeg_by_name.end()) continue;
+        printf("%s: webp is %.0f%% of the jpeg bytes, decodes in %.2fx its time\n", r.name.c_str(),
+               100.0 * r.bytes / it->second->bytes, r.decode_us / it->second->decode_us);
+    }
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Per-frame culling cost against list size, up to 100k entries:
+//
+//   build/tools/cull-bench
+//
+// Compares card_visible_span with the walk mal_source_render used to do
+// (every entry, twice, tested against the view), checks that both find the
+// same cards, and fails if the span's cost grows with the list.
+
+#include "card-layout.hpp"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static const float ITEM_WIDTH = 200.0f;
+static const float ITEM_GAP = 10.0f;
+static const float VIEW_WIDTH = 1920.0f;
+static const float SCROLL_STEP = 37.5f; // per frame; not a multiple of the pitch
+static const int FRAMES = 20000;
+
+struct visited_card {
+    size_t index;
+    float x;
+};
+
+// The culling loop before card_visible_span: both copies of the strip,
+// every entry tested
+static void walk_all(const card_layout_params &params, size_t n, float scroll_offset,
+                     std::vector<visited_card> &out)
+{
+    out.clear();
+    const float total_width = params.pitch * n;
+    for (int pass = 0; pass < 2; pass++) {
+        float base_x = -scroll_offset + (pass > 0 ? total_width : 0.0f);
+        for (size_t i = 0; i < n; i++) {
+            float x = base_x + i * params.pitch;
+            if (x + params.item_width < 0 || x > VIEW_WIDTH) continue;
+            out.push_back({i, x});
+        }
+    }
+}
+
+// The culling loop in mal_source_render now
+static void walk_span(const card_layout_params &params, size_t n, float scroll_offset,
+                      std::vector<visited_card> &out)
+{
+    out.clear();
+    card_span span = card_visible_span(params, n, scroll_offset, VIEW_WIDTH);
+    for (size_t k = 0; k < span.count; k++) {
+        float x = span.x0 + k * params.pitch;
+        if (x + params.item_width < 0 || x > VIEW_WIDTH) continue;
+        out.push_back({(span.first + k) % n, x});
+    }
+}
+
+using walk_fn = void (*)(const card_layout_params &, size_t, float, std::vector<visited_card> &);
+
+// Nanoseconds per frame, scrolling through the list as the tick would
+static double time_walk(walk_fn walk, const card_layout_params &params, size_t n, int frames,
+                        size_t *visited)
+{
+    std::vector<visited_card> cards;
+    const float total_width = params.pitch * n;
+    float scroll_offset = 0.0f;
+    size_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+        walk(params, n, scroll_offset, cards);
+        total += cards.size();
+        scroll_offset += SCROLL_STEP;
+        if (scroll_offset >= total_width) scroll_offset -= total_width;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    *visited = total;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / frames;
+}
+
+// Both walks must visit the same cards at the same positions, including
+// across the wrap-around
+static bool same_cards(const card_layout_params &params, size_t n)
+{
+    std::vector<visited_card> a, b;
+    const float total_width = params.pitch * n;
+    for (float offset = 0.0f; offset < total_width; offset += total_width / 97.0f) {
+        walk_all(params, n, offset, a);
+        walk_span(params, n, offset, b);
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].index != b[i].index || a[i].x - b[i].x > 0.01f || b[i].x - a[i].x > 0.01f) return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    card_layout_params params = {};
+    params.item_width = ITEM_WIDTH;
+    params.pitch = ITEM_WIDTH + ITEM_GAP;
+
+    static const size_t SIZES[] = {10, 100, 1000, 10000, 100000};
+    int failed = 0;
+    double span_smallest = 0.0;
+    double span_largest = 0.0;
+
+    printf("%8s %14s %14s %8s\n", "entries", "span ns/frame", "walk ns/frame", "cards");
+    for (size_t n : SIZES) {
+        if (!same_cards(params, n)) {
+            printf("FAIL %zu entries: span and walk disagree\n", n);
+            failed++;
+        }
+
+        size_t span_cards = 0;
+        size_t walk_cards = 0;
+        double span_ns = time_walk(walk_span, params, n, FRAMES, &span_cards);
+        // The old walk is O(n); fewer frames keep the 100k run short
+        int walk_frames = n >= 10000 ? 200 : FRAMES;
+        double walk_ns = time_walk(walk_all, params, n, walk_frames, &walk_cards);
+        printf("%8zu %14.1f %14.1f %8.1f\n", n, span_ns, walk_ns, (double)span_cards / FRAMES);
+
+        if (n == SIZES[0]) span_smallest = span_ns;
+        span_largest = span_ns;
+    }
+
+    // Flat with respect to list size: 10,000x the entries, same per-frame
+    // cost give or take timer noise
+    bool flat = span_largest < span_smallest * 4.0 + 200.0;
+    printf("%s span cost at 100000 entries is within 4x of 10 entries\n", flat ? "PASS" : "FAIL");
+    if (!flat) failed++;
+
+    return failed == 0 ? 0 : 1;
+}
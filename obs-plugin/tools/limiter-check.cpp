@@ -0,0 +1,78 @@
+// Checks the per-host request pacing (http-limiter) against the stand-in
+// server in replay-server.js:
+//
+//   node replay-server.js -- build/tools/limiter-check
+//
+// 127.0.0.1 and localhost reach the same server but are separate hosts to
+// the limiter, so the throttling cases do not disturb the pacing ones.
+
+#include "http-client.hpp"
+#include <cstdio>
+#include <string>
+#include <util/platform.h>
+
+static int g_failed = 0;
+
+static void check(const char *name, bool ok, double seconds)
+{
+    printf("%s %s (%.2f s)\n", ok ? "PASS" : "FAIL", name, seconds);
+    if (!ok) g_failed++;
+}
+
+// Seconds taken by `count` requests for base + path; returns the status of
+// the last one (200, or the status of the error it threw)
+static double timed_fetch(const std::string &url, http_pacing pacing, int count, long *status = nullptr)
+{
+    uint64_t start = os_gettime_ns();
+    for (int i = 0; i < count; i++) {
+        http_request req;
+        req.url = url;
+        req.pacing = pacing;
+        try {
+            http_fetch(req);
+            if (status) *status = 200;
+        } catch (const http_status_error &e) {
+            if (status) *status = e.status;
+        } catch (const std::exception &) {
+            if (status) *status = 0;
+        }
+    }
+    return (os_gettime_ns() - start) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <base url of replay-server.js>\n", argv[0]);
+        return 2;
+    }
+    const std::string paced = argv[argc - 1];
+    std::string throttled = paced;
+    size_t host = throttled.find("127.0.0.1");
+    if (host != std::string::npos) throttled.replace(host, 9, "localhost");
+
+    // Covers: burst of 20, then 20/s
+    double t = timed_fetch(paced + "/asset/cover.jpg", http_pacing::asset, 30);
+    check("30 asset requests finish within 1.5 s", t < 1.5, t);
+
+    // List calls to the same host keep their own bucket: burst of 4, then 1/s
+    t = timed_fetch(paced + "/asset/list.json", http_pacing::api, 6);
+    check("6 API requests take at least 1.8 s", t >= 1.8, t);
+
+    // A broken cover is that cover's problem, not the host's
+    long status = 0;
+    timed_fetch(throttled + "/status/500", http_pacing::asset, 6, &status);
+    t = timed_fetch(throttled + "/asset/cover.jpg", http_pacing::asset, 1, &status);
+    check("asset 500s neither back off nor open the breaker", status == 200 && t < 0.5, t);
+
+    // Throttling does back covers off, for at least Retry-After
+    timed_fetch(throttled + "/status/429?retry_after=2", http_pacing::asset, 1);
+    t = timed_fetch(throttled + "/asset/cover.jpg", http_pacing::asset, 1, &status);
+    check("asset 429 with Retry-After: 2 delays the next asset request", status == 200 && t >= 1.9, t);
+
+    timed_fetch(throttled + "/status/503?retry_after=2", http_pacing::api, 1);
+    t = timed_fetch(throttled + "/asset/list.json", http_pacing::api, 1, &status);
+    check("API 503 with Retry-After: 2 delays the next API request", status == 200 && t >= 1.9, t);
+
+    return g_failed == 0 ? 0 : 1;
+}
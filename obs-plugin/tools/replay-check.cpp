@@ -0,0 +1,236 @@
+// Runs the list backends against the recorded responses replayed by
+// replay-server.js:
+//
+//   node replay-server.js -- build/tools/replay-check
+//
+// Covers the AniList status mapping and grouping, the MyAnimeList API v2
+// paging (including how many pages it requests at once) and the
+// MyAnimeList list-page scraping. The API backend gets 127.0.0.1 and the
+// others localhost, so each host's request pacing only holds up its own
+// cases.
+
+#include "list-backend.hpp"
+#include "http-client.hpp"
+#include <cstdio>
+#include <map>
+#include <set>
+#include <nlohmann/json.hpp>
+#include <obs-module.h>
+
+// list-store (linked for the companion backend) resolves its save path
+// through the module
+OBS_DECLARE_MODULE()
+
+static int g_failed = 0;
+
+static void check(const char *name, bool ok, const std::string &detail = "")
+{
+    printf("%s %s%s%s\n", ok ? "PASS" : "FAIL", name, detail.empty() ? "" : ": ", detail.c_str());
+    if (!ok) g_failed++;
+}
+
+// Requests the server has served since the last call, and the most it had
+// in flight at once
+struct served_requests {
+    std::vector<std::string> requests;
+    int max_in_flight = 0;
+};
+
+static served_requests take_log(const std::string &base)
+{
+    http_request req;
+    req.url = base + "/log";
+    req.pacing = http_pacing::asset; // not counted against the list requests' pacing
+    auto json = nlohmann::json::parse(http_fetch(req));
+
+    served_requests log;
+    log.requests = json.at("requests").get<std::vector<std::string>>();
+    log.max_in_flight = json.at("max_in_flight").get<int>();
+    return log;
+}
+
+static std::vector<MALEntry> fetch(const list_key &key, std::string *error)
+{
+    try {
+        return list_backend_create(key)->fetch(key, nullptr, nullptr);
+    } catch (const std::exception &e) {
+        *error = e.what();
+        return {};
+    }
+}
+
+// "media status title" for each entry, in order
+static std::vector<std::string> describe(const std::vector<MALEntry> &entries)
+{
+    std::vector<std::string> out;
+    for (const auto &e : entries) out.push_back(e.media + " " + e.status + " " + e.title);
+    return out;
+}
+
+static std::string join(const std::vector<std::string> &items)
+{
+    std::string out;
+    for (const auto &item : items) out += (out.empty() ? "" : " | ") + item;
+    return out;
+}
+
+static void check_anilist(const std::string &host)
+{
+    list_key key;
+    key.backend = "anilist";
+    key.endpoint = host;
+    key.username = "replayuser";
+    key.media = "both";
+    key.status = "ALL";
+    key.first_status = "COMPLETED";
+
+    std::string error;
+    auto entries = fetch(key, &error);
+    served_requests log = take_log(host);
+    check("AniList ALL + both is two requests", error.empty() && log.requests.size() == 2,
+          error.empty() ? join(log.requests) : error);
+
+    // Custom lists skipped, CURRENT/REPEATING mapped per media, statuses
+    // grouped from first_status on, manga before anime within a status
+    const std::vector<std::string> expected = {
+        "manga COMPLETED Berserk",
+        "anime COMPLETED Fullmetal Alchemist: Brotherhood",
+        "anime COMPLETED Steins;Gate",
+        "manga READING ONE PIECE",
+        "anime WATCHING ONE PIECE",
+        "anime WATCHING Cowboy Bebop",
+        "anime PAUSED NARUTO",
+        "manga DROPPED NARUTO",
+        "anime PLANNING Tengen Toppa Gurren Lagann",
+    };
+    check("AniList entries are mapped and in display order", describe(entries) == expected,
+          join(describe(entries)));
+
+    // Cowboy Bebop's cover is null, manga NARUTO has no coverImage at all
+    size_t without_cover = 0;
+    for (const auto &e : entries) {
+        if (e.coverImage.empty()) without_cover++;
+    }
+    check("AniList null covers are read as no cover", error.empty() && entries.size() == 9 && without_cover == 2,
+          std::to_string(without_cover) + " without a cover");
+
+    // One status: asked of AniList as CURRENT for both media
+    key.status = "READING";
+    key.first_status.clear();
+    entries = fetch(key, &error);
+    take_log(host);
+    const std::vector<std::string> in_progress = {"manga READING ONE PIECE", "anime WATCHING ONE PIECE"};
+    check("AniList READING asks for CURRENT of each media", describe(entries) == in_progress,
+          error.empty() ? join(describe(entries)) : error);
+}
+
+static void check_mal_api(const std::string &host)
+{
+    list_key key;
+    key.backend = "mal_api";
+    key.endpoint = host;
+    key.client_id = "replay";
+    key.username = "long"; // 4500 entries: pages of 1000
+    key.media = "anime";
+    key.status = "ALL";
+
+    std::string error;
+    auto entries = fetch(key, &error);
+    served_requests log = take_log(host);
+
+    // Every entry once, and in page order within each status group (the
+    // display order groups the repeated statuses)
+    std::set<int> ids;
+    std::map<std::string, int> last_id;
+    bool in_order = true;
+    for (const auto &e : entries) {
+        int id = std::stoi(e.id);
+        ids.insert(id);
+        if (last_id.count(e.status) && last_id[e.status] >= id) in_order = false;
+        last_id[e.status] = id;
+    }
+    bool complete = entries.size() == 4500 && ids.size() == 4500 && *ids.begin() == 100000 && *ids.rbegin() == 104499;
+    check("MAL API pages through all 4500 entries in order", error.empty() && complete && in_order,
+          error.empty() ? std::to_string(entries.size()) + " entries" : error);
+
+    // The first page, then batches of 1, 2 and PAGE_CONCURRENCY pages while
+    // they come back full: offsets 0, 1000, 2000-3000 and 4000-6000. The
+    // first four spend the limiter's burst, so the last batch goes out one
+    // page at a time and the pair is the most in flight.
+    check("MAL API requests 7 pages, 2 of them at once", log.requests.size() == 7 && log.max_in_flight == 2,
+          std::to_string(log.requests.size()) + " requests, " + std::to_string(log.max_in_flight) + " at once");
+
+    // A list ending in the second page asks for nothing past it
+    key.username = "long1500";
+    entries = fetch(key, &error);
+    log = take_log(host);
+    check("MAL API stops after the last page of 1500 entries",
+          error.empty() && entries.size() == 1500 && log.requests.size() == 2 && log.max_in_flight == 1,
+          error.empty() ? std::to_string(log.requests.size()) + " requests, " +
+                              std::to_string(log.max_in_flight) + " at once"
+                        : error);
+
+    key.username = "replayuser";
+    entries = fetch(key, &error);
+    take_log(host);
+    const std::vector<std::string> expected = {
+        "anime WATCHING One Piece",
+        "anime COMPLETED Fullmetal Alchemist: Brotherhood",
+        "anime PAUSED Naruto",
+        "anime DROPPED Bleach",
+        "anime PLANNING Tengen Toppa Gurren Lagann",
+    };
+    check("MAL API statuses are mapped", describe(entries) == expected,
+          error.empty() ? join(describe(entries)) : error);
+    check("MAL API progress and covers are read",
+          entries.size() == 5 && entries[0].progress == 1071 &&
+              entries[0].coverImage == "https://cdn.myanimelist.net/images/anime/1244/138851.jpg" &&
+              entries[4].coverImage == MALFetcher::normalizeImageUrl(""));
+}
+
+static void check_mal_web(const std::string &host)
+{
+    list_key key;
+    key.backend = "mal";
+    key.endpoint = host;
+    key.username = "replayuser";
+    key.media = "anime";
+    key.status = "ALL";
+
+    std::string error;
+    auto entries = fetch(key, &error);
+    served_requests log = take_log(host);
+    check("MAL list pages: ALL is one page per status", error.empty() && log.requests.size() == 5,
+          error.empty() ? join(log.requests) : error);
+
+    const std::vector<std::string> expected = {
+        "anime WATCHING One Piece",
+        "anime COMPLETED Fullmetal Alchemist: Brotherhood",
+        "anime COMPLETED Steins;Gate & \"Friends\"",
+        "anime PAUSED Naruto",
+        "anime PLANNING Tengen Toppa Gurren Lagann",
+    };
+    check("MAL list pages: data-items unescaped and grouped by status", describe(entries) == expected,
+          join(describe(entries)));
+    check("MAL list pages: relative cover paths made absolute",
+          entries.size() == 5 && entries[2].coverImage == "https://cdn.myanimelist.net/images/anime/1935/127974.jpg");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <base url of replay-server.js>\n", argv[0]);
+        return 2;
+    }
+    const std::string api_host = argv[argc - 1];
+    std::string other_host = api_host;
+    size_t host = other_host.find("127.0.0.1");
+    if (host != std::string::npos) other_host.replace(host, 9, "localhost");
+
+    take_log(api_host);
+    check_mal_api(api_host);
+    check_anilist(other_host);
+    check_mal_web(other_host);
+
+    return g_failed == 0 ? 0 : 1;
+}
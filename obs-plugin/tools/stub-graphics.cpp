@@ -0,0 +1,111 @@
+#include "stub-graphics.hpp"
+#include <graphics/graphics.h>
+#include <util/profiler.h>
+
+struct gs_texture {
+    uint32_t width;
+    uint32_t height;
+};
+
+// Distinct non-null handles for the base effects and their techniques/params
+static char g_handles[4];
+
+stub_graphics_counters stub_graphics = {};
+std::vector<gs_texture_t *> *stub_draw_trace = nullptr;
+
+gs_texture_t *stub_texture_create(uint32_t width, uint32_t height)
+{
+    return new gs_texture{width, height};
+}
+
+void stub_texture_destroy(gs_texture_t *tex)
+{
+    delete tex;
+}
+
+gs_effect_t *obs_get_base_effect(enum obs_base_effect effect)
+{
+    return reinterpret_cast<gs_effect_t *>(&g_handles[effect == OBS_EFFECT_SOLID ? 1 : 0]);
+}
+
+gs_technique_t *gs_effect_get_technique(const gs_effect_t *, const char *)
+{
+    return reinterpret_cast<gs_technique_t *>(&g_handles[2]);
+}
+
+gs_eparam_t *gs_effect_get_param_by_name(const gs_effect_t *, const char *)
+{
+    return reinterpret_cast<gs_eparam_t *>(&g_handles[3]);
+}
+
+size_t gs_technique_begin(gs_technique_t *)
+{
+    stub_graphics.technique_begins++;
+    return 1;
+}
+
+bool gs_technique_begin_pass(gs_technique_t *, size_t)
+{
+    return true;
+}
+
+void gs_technique_end_pass(gs_technique_t *) {}
+void gs_technique_end(gs_technique_t *) {}
+
+void gs_effect_set_texture(gs_eparam_t *, gs_texture_t *)
+{
+    stub_graphics.texture_binds++;
+}
+
+void gs_effect_set_vec4(gs_eparam_t *, const struct vec4 *) {}
+
+uint32_t gs_texture_get_width(const gs_texture_t *tex)
+{
+    return tex ? tex->width : 0;
+}
+
+uint32_t gs_texture_get_height(const gs_texture_t *tex)
+{
+    return tex ? tex->height : 0;
+}
+
+void gs_draw_sprite(gs_texture_t *tex, uint32_t, uint32_t, uint32_t)
+{
+    stub_graphics.draws++;
+    if (stub_draw_trace) stub_draw_trace->push_back(tex);
+}
+
+void gs_draw_sprite_subregion(gs_texture_t *tex, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t)
+{
+    stub_graphics.draws++;
+    if (stub_draw_trace) stub_draw_trace->push_back(tex);
+}
+
+void gs_matrix_push(void) {}
+void gs_matrix_pop(void) {}
+void gs_matrix_translate3f(float, float, float) {}
+void gs_matrix_scale3f(float, float, float) {}
+void gs_blend_state_push(void) {}
+void gs_blend_state_pop(void) {}
+void gs_blend_function(enum gs_blend_type, enum gs_blend_type) {}
+void gs_blend_function_separate(enum gs_blend_type, enum gs_blend_type, enum gs_blend_type, enum gs_blend_type) {}
+
+void gs_texrender_reset(gs_texrender_t *) {}
+
+bool gs_texrender_begin(gs_texrender_t *, uint32_t, uint32_t)
+{
+    return false;
+}
+
+void gs_texrender_end(gs_texrender_t *) {}
+
+gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *)
+{
+    return nullptr;
+}
+
+void gs_ortho(float, float, float, float, float, float) {}
+void gs_clear(uint32_t, const struct vec4 *, float, uint8_t) {}
+
+void profile_start(const char *) {}
+void profile_end(const char *) {}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <obs-module.h>
+#include <cstdint>
+#include <vector>
+
+// Stand-in for the libobs graphics calls made by card-layout.cpp and
+// render-state.cpp, so their CPU side can be measured without OBS or a GPU.
+// Parameters the stubs ignore are left unnamed.
+// Textures are plain width/height records; draws and state changes are only
+// counted, and the drawn textures optionally traced in order.
+
+struct stub_graphics_counters {
+    uint64_t draws;
+    uint64_t technique_begins;
+    uint64_t texture_binds;
+};
+
+extern stub_graphics_counters stub_graphics;
+
+// When set, every draw appends its texture here
+extern std::vector<gs_texture_t *> *stub_draw_trace;
+
+gs_texture_t *stub_texture_create(uint32_t width, uint32_t height);
+void stub_texture_destroy(gs_texture_t *tex);
@@ -0,0 +1,209 @@
+// Offline stand-in for the hosts the OBS plugin talks to, used by the checks
+// in obs-plugin/tools. Plain Node, no dependencies.
+//
+//   node replay-server.js                  serve on REPLAY_PORT (default 3901)
+//   node replay-server.js -- <cmd> [args]  serve on a free port, run <cmd> with
+//                                          the base URL as its last argument,
+//                                          and exit with its exit code
+//
+// Routes:
+//   GET /status/<code>[?retry_after=<s>]  answers <code>, with Retry-After if given
+//   GET /asset/<name>                     a small static file (stands in for a cover)
+//   GET /log                              requests served since the last /log, and
+//                                         the most that were in flight at once
+//
+// Recorded list responses (replay-fixtures/), replayed in place of each host:
+//   POST /                                AniList GraphQL (graphql.anilist.co)
+//   GET  /v2/users/<name>/<media>list     MyAnimeList API v2 (api.myanimelist.net)
+//   GET  /<media>list/<name>?status=<n>   MyAnimeList list page (myanimelist.net)
+//
+// The recordings are filtered by the status asked for. The API listing is
+// paged by the request's limit and offset; for the user "long" its entries
+// are repeated up to LONG_LIST_SIZE ("long<n>": n entries), so a fetch spans
+// several pages. For the
+// user "flaky", the list page of FLAKY_STATUS is served once and then
+// answers 503, as a scrape that fails now and then would.
+
+const fs = require('fs');
+const http = require('http');
+const path = require('path');
+const { spawn } = require('child_process');
+
+const FIXTURES = path.join(__dirname, 'replay-fixtures');
+const LONG_LIST_SIZE = 4500;
+const API_DELAY_MS = 100; // per API page, so concurrent requests overlap
+const FLAKY_STATUS = 2;
+
+const fixture = name => fs.readFileSync(path.join(FIXTURES, name), 'utf8');
+
+let served = [];
+let flakyServed = false;
+let inFlight = 0;
+let maxInFlight = 0;
+
+const sendJson = (res, status, value) => {
+  res.writeHead(status, { 'Content-Type': 'application/json' });
+  res.end(JSON.stringify(value));
+};
+
+// MAL list page status codes
+const WEB_STATUS = { 1: 'in progress', 2: 'completed', 3: 'on hold', 4: 'dropped', 6: 'planned', 7: 'all' };
+
+const routes = [
+  {
+    pattern: /^\/log$/,
+    untracked: true,
+    handle: (req, res) => {
+      sendJson(res, 200, { requests: served, max_in_flight: maxInFlight });
+      served = [];
+      maxInFlight = 0;
+    }
+  },
+  {
+    method: 'POST',
+    pattern: /^\/$/,
+    handle: (req, res, match, query, body) => {
+      let variables;
+      try {
+        variables = JSON.parse(body).variables || {};
+      } catch (err) {
+        sendJson(res, 400, { errors: [{ message: 'Invalid JSON in request body' }] });
+        return;
+      }
+      if (variables.type !== 'ANIME' && variables.type !== 'MANGA') {
+        sendJson(res, 200, { errors: [{ message: 'Variable "$type" is required' }], data: null });
+        return;
+      }
+      const recorded = JSON.parse(fixture(`anilist-${variables.type.toLowerCase()}.json`));
+      const collection = recorded.data.MediaListCollection;
+      if (variables.status) {
+        collection.lists = collection.lists
+          .map(list => ({ ...list, entries: list.entries.filter(e => e.status === variables.status) }))
+          .filter(list => list.entries.length > 0);
+      }
+      sendJson(res, 200, recorded);
+    }
+  },
+  {
+    pattern: /^\/v2\/users\/([\w-]+)\/(anime|manga)list$/,
+    handle: (req, res, match, query) => {
+      if (!req.headers['x-mal-client-id']) {
+        sendJson(res, 401, { error: 'invalid_token', message: 'token is missing' });
+        return;
+      }
+      const [, user, media] = match;
+      let items = JSON.parse(fixture(`mal-api-${media}list.json`)).data;
+      const long = /^long(\d+)?$/.exec(user);
+      if (long) {
+        const size = long[1] ? Number(long[1]) : LONG_LIST_SIZE;
+        const recorded = items;
+        items = [];
+        for (let i = 0; i < size; i++) {
+          const item = recorded[i % recorded.length];
+          items.push({ ...item, node: { ...item.node, id: 100000 + i } });
+        }
+      }
+      if (query.get('status')) items = items.filter(i => i.list_status.status === query.get('status'));
+
+      const limit = Number(query.get('limit')) || 100;
+      const offset = Number(query.get('offset')) || 0;
+      const page = { data: items.slice(offset, offset + limit), paging: {} };
+      const pageUrl = pageOffset => {
+        const params = new URLSearchParams(query);
+        params.set('offset', pageOffset);
+        return `http://${req.headers.host}${match[0]}?${params}`;
+      };
+      if (offset > 0) page.paging.previous = pageUrl(Math.max(offset - limit, 0));
+      if (offset + limit < items.length) page.paging.next = pageUrl(offset + limit);
+      setTimeout(() => sendJson(res, 200, page), API_DELAY_MS);
+    }
+  },
+  {
+    pattern: /^\/(anime|manga)list\/([\w-]+)$/,
+    handle: (req, res, match, query) => {
+      const [, media, user] = match;
+      if (media !== 'anime') {
+        res.writeHead(404, { 'Content-Type': 'text/html' });
+        res.end('<html><body>No recording</body></html>\n');
+        return;
+      }
+      const status = Number(query.get('status')) || 7;
+      if (!WEB_STATUS[status]) {
+        res.writeHead(400, { 'Content-Type': 'text/html' });
+        res.end('<html><body>Invalid status</body></html>\n');
+        return;
+      }
+      if (user === 'flaky' && status === FLAKY_STATUS) {
+        if (flakyServed) {
+          res.writeHead(503, { 'Content-Type': 'text/html' });
+          res.end('<html><body>Service Unavailable</body></html>\n');
+          return;
+        }
+        flakyServed = true;
+      }
+      const page = fixture('mal-animelist.html').replace(/data-items="([^"]*)"/, (all, escaped) => {
+        const items = JSON.parse(escaped.replace(/&quot;/g, '"').replace(/&amp;/g, '&'));
+        const kept = status === 7 ? items : items.filter(i => i.status === status);
+        return `data-items="${JSON.stringify(kept).replace(/&/g, '&amp;').replace(/"/g, '&quot;')}"`;
+      });
+      res.writeHead(200, { 'Content-Type': 'text/html; charset=utf-8' });
+      res.end(page);
+    }
+  },
+  {
+    pattern: /^\/status\/(\d{3})$/,
+    handle: (req, res, match, query) => {
+      const headers = { 'Content-Type': 'text/plain' };
+      if (query.get('retry_after')) headers['Retry-After'] = query.get('retry_after');
+      res.writeHead(Number(match[1]), headers);
+      res.end(`status ${match[1]}\n`);
+    }
+  },
+  {
+    pattern: /^\/asset\/([\w.-]+)$/,
+    handle: (req, res, match) => {
+      res.writeHead(200, { 'Content-Type': 'application/octet-stream' });
+      res.end(Buffer.alloc(1024, match[1]));
+    }
+  }
+];
+
+function handleRequest(req, res) {
+  const url = new URL(req.url, 'http://localhost');
+  for (const route of routes) {
+    const match = url.pathname.match(route.pattern);
+    if (match && (route.method || 'GET') === req.method) {
+      if (!route.untracked) {
+        served.push(`${req.method} ${url.pathname}${url.search}`);
+        maxInFlight = Math.max(maxInFlight, ++inFlight);
+        res.on('close', () => { inFlight--; });
+      }
+      let body = '';
+      req.on('data', chunk => { body += chunk; });
+      req.on('end', () => route.handle(req, res, match, url.searchParams, body));
+      return;
+    }
+  }
+  res.writeHead(404, { 'Content-Type': 'text/plain' });
+  res.end('not found\n');
+}
+
+const server = http.createServer(handleRequest);
+const separator = process.argv.indexOf('--');
+
+if (separator < 0) {
+  const port = Number(process.env.REPLAY_PORT) || 3901;
+  server.listen(port, '127.0.0.1', () => {
+    console.log(`Replay server on http://127.0.0.1:${port}`);
+  });
+} else {
+  const [cmd, ...args] = process.argv.slice(separator + 1);
+  server.listen(0, '127.0.0.1', () => {
+    const base = `http://127.0.0.1:${server.address().port}`;
+    const child = spawn(cmd, [...args, base], { stdio: 'inherit' });
+    child.on('exit', code => {
+      server.close();
+      process.exit(code === null ? 1 : code);
+    });
+  });
+}
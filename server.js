@@ -170,6 +170,8 @@ try {
   console.warn('Warning: config.json not found. Using example config. Please create config.json from config.example.json');
 }
 const PORT = config.port || 3000;
+// Where list pages are scraped from; the offline checks point this at replay-server.js
+const MAL_BASE_URL = (config.malBaseUrl || 'https://myanimelist.net').replace(/\/+$/, '');
 app.use(cors());
 const staticDir = fs.existsSync(path.join(process.cwd(), 'public'))
   ? path.join(process.cwd(), 'public')
@@ -180,7 +182,7 @@ const mediaConfigs = {
   manga: {
     statusMap: { READING: '1', COMPLETED: '2', PAUSED: '3', DROPPED: '4', PLANNING: '6', ALL: '7' },
     statusNames: { '1': 'READING', '2': 'COMPLETED', '3': 'PAUSED', '4': 'DROPPED', '6': 'PLANNING' },
-    url: (username, statusCode) => `https://myanimelist.net/mangalist/${username}?status=${statusCode}`,
+    url: (username, statusCode) => `${MAL_BASE_URL}/mangalist/${username}?status=${statusCode}`,
     idKey: 'manga_id',
     titleKey: 'manga_title',
     imageKey: 'manga_image_path',
@@ -190,7 +192,7 @@ const mediaConfigs = {
   anime: {
     statusMap: { WATCHING: '1', COMPLETED: '2', PAUSED: '3', DROPPED: '4', PLANNING: '6', ALL: '7' },
     statusNames: { '1': 'WATCHING', '2': 'COMPLETED', '3': 'PAUSED', '4': 'DROPPED', '6': 'PLANNING' },
-    url: (username, statusCode) => `https://myanimelist.net/animelist/${username}?status=${statusCode}`,
+    url: (username, statusCode) => `${MAL_BASE_URL}/animelist/${username}?status=${statusCode}`,
     idKey: 'anime_id',
     titleKey: 'anime_title',
     imageKey: 'anime_image_path',
@@ -257,6 +259,59 @@ async function scrapeList(username, status, media = 'manga') {
   }
 }
 
+// Status names differ per media for entries in progress
+function statusForMedia(status, mediaType) {
+  if (mediaType === 'manga' && status === 'WATCHING') return 'READING';
+  if (mediaType === 'anime' && status === 'READING') return 'WATCHING';
+  return status;
+}
+
+// With requireAll, a status of ALL that fails to scrape fails the whole
+// fetch instead of being left out of the list
+async function fetchItems(status, mediaTypes, requireAll = false) {
+  const items = [];
+  const seen = new Set();
+
+  for (const mediaType of mediaTypes) {
+    const mediaConfig = mediaConfigs[mediaType] || mediaConfigs.manga;
+    
+    if (status === 'ALL') {
+      const statuses = mediaConfig.defaultStatuses;
+      const results = await Promise.allSettled(statuses.map(s => scrapeList(config.malUsername, s, mediaType)));
+
+      results.forEach((result, idx) => {
+        if (result.status === 'fulfilled') {
+          if (config.debug) {
+            console.log(`Fetched ${result.value.length} ${mediaType} items for ${statuses[idx]}`);
+          }
+          result.value.forEach(entry => {
+            const uniqueKey = `${entry.media}-${entry.id}`;
+            if (!seen.has(uniqueKey)) {
+              seen.add(uniqueKey);
+              items.push(entry);
+            }
+          });
+        } else {
+          const message = `Error fetching ${statuses[idx]} (${mediaType}): ${result.reason?.message || result.reason}`;
+          if (requireAll) throw new Error(message);
+          console.error(message);
+        }
+      });
+    } else {
+      const list = await scrapeList(config.malUsername, statusForMedia(status, mediaType), mediaType);
+      list.forEach(entry => {
+        const uniqueKey = `${entry.media}-${entry.id}`;
+        if (!seen.has(uniqueKey)) {
+          seen.add(uniqueKey);
+          items.push(entry);
+        }
+      });
+    }
+  }
+
+  return items;
+}
+
 async function handleListRequest(req, res, mediaOverride) {
   const status = req.query.status || 'ALL';
   const speed = req.query.speed ? parseInt(req.query.speed, 10) : config.scrollSpeed;
@@ -271,43 +326,7 @@ async function handleListRequest(req, res, mediaOverride) {
   }
 
   try {
-    let items = [];
-    const seen = new Set();
-
-    for (const mediaType of mediaTypes) {
-      const mediaConfig = mediaConfigs[mediaType] || mediaConfigs.manga;
-      
-      if (status === 'ALL') {
-        const statuses = mediaConfig.defaultStatuses;
-        const results = await Promise.allSettled(statuses.map(s => scrapeList(config.malUsername, s, mediaType)));
-
-        results.forEach((result, idx) => {
-          if (result.status === 'fulfilled') {
-            if (config.debug) {
-              console.log(`Fetched ${result.value.length} ${mediaType} items for ${statuses[idx]}`);
-            }
-            result.value.forEach(entry => {
-              const uniqueKey = `${entry.media}-${entry.id}`;
-              if (!seen.has(uniqueKey)) {
-                seen.add(uniqueKey);
-                items.push(entry);
-              }
-            });
-          } else {
-            console.error(`Error fetching ${statuses[idx]} (${mediaType}):`, result.reason?.message || result.reason);
-          }
-        });
-      } else {
-        const list = await scrapeList(config.malUsername, status, mediaType);
-        list.forEach(entry => {
-          const uniqueKey = `${entry.media}-${entry.id}`;
-          if (!seen.has(uniqueKey)) {
-            seen.add(uniqueKey);
-            items.push(entry);
-          }
-        });
-      }
-    }
+    const items = await fetchItems(status, mediaTypes);
 
     const sortBy = req.query.sort || 'default';
     if (sortBy === 'title') {
@@ -328,6 +347,105 @@ async function handleListRequest(req, res, mediaOverride) {
   }
 }
 
+// Server-Sent Events feed of a list for long-lived clients (the native OBS
+// plugin): the whole list once, then only what changed. Clients asking for
+// the same list share one watcher, which re-scrapes every pushInterval
+// seconds and stops when its last client disconnects.
+const PUSH_INTERVAL_MS = (config.pushInterval || 300) * 1000;
+const KEEP_ALIVE_MS = 20 * 1000;
+const streamWatchers = new Map();
+
+function sendEvent(res, event, data) {
+  res.write(`event: ${event}\ndata: ${JSON.stringify(data)}\n\n`);
+}
+
+function diffItems(previous, items) {
+  const key = entry => `${entry.media}-${entry.id}`;
+  const before = new Map(previous.map(entry => [key(entry), entry]));
+  const after = new Set(items.map(key));
+  const added = [];
+  const updated = [];
+
+  items.forEach(entry => {
+    const old = before.get(key(entry));
+    if (!old) {
+      added.push(entry);
+    } else if (old.title !== entry.title || old.coverImage !== entry.coverImage ||
+               old.status !== entry.status || old.progress !== entry.progress) {
+      updated.push(entry);
+    }
+  });
+  const removed = previous.map(key).filter(k => !after.has(k));
+
+  return { added, removed, updated };
+}
+
+async function pollWatcher(watcher) {
+  try {
+    // A status missing from a partial list would be pushed as removed
+    const items = await fetchItems(watcher.status, watcher.mediaTypes, true);
+    if (!watcher.items) {
+      watcher.items = items;
+      watcher.clients.forEach(res => sendEvent(res, 'snapshot', { items }));
+      return;
+    }
+
+    const diff = diffItems(watcher.items, items);
+    watcher.items = items;
+    if (diff.added.length || diff.removed.length || diff.updated.length) {
+      if (config.debug) {
+        console.log(`Pushing ${watcher.key}: +${diff.added.length} -${diff.removed.length} ~${diff.updated.length}`);
+      }
+      watcher.clients.forEach(res => sendEvent(res, 'diff', diff));
+    }
+  } catch (error) {
+    // Clients keep the last list they were sent
+    console.error(`Error refreshing ${watcher.key}:`, error.message);
+  }
+}
+
+app.get('/api/stream', (req, res) => {
+  const status = req.query.status || 'ALL';
+  const media = (req.query.media || 'manga').toLowerCase();
+  const mediaTypes = media === 'both' ? ['manga', 'anime'] : [media];
+
+  if (!config.malUsername || config.malUsername === 'YOUR_USERNAME') {
+    return res.status(400).json({
+      error: 'MyAnimeList username not configured. Please set malUsername in config.json'
+    });
+  }
+
+  res.writeHead(200, {
+    'Content-Type': 'text/event-stream',
+    'Cache-Control': 'no-cache',
+    Connection: 'keep-alive'
+  });
+  res.write(': connected\n\n');
+
+  const key = `${media}:${status}`;
+  let watcher = streamWatchers.get(key);
+  if (!watcher) {
+    watcher = { key, status, mediaTypes, items: null, clients: new Set() };
+    watcher.poll = setInterval(() => pollWatcher(watcher), PUSH_INTERVAL_MS);
+    watcher.keepAlive = setInterval(() => watcher.clients.forEach(client => client.write(': keep-alive\n\n')),
+      KEEP_ALIVE_MS);
+    streamWatchers.set(key, watcher);
+    pollWatcher(watcher);
+  } else if (watcher.items) {
+    sendEvent(res, 'snapshot', { items: watcher.items });
+  }
+  watcher.clients.add(res);
+
+  req.on('close', () => {
+    watcher.clients.delete(res);
+    if (watcher.clients.size === 0) {
+      clearInterval(watcher.poll);
+      clearInterval(watcher.keepAlive);
+      streamWatchers.delete(key);
+    }
+  });
+});
+
 app.get('/api/list', (req, res) => handleListRequest(req, res));
 app.get('/api/manga', (req, res) => handleListRequest(req, res, 'manga'));
 app.get('/api/anime', (req, res) => handleListRequest(req, res, 'anime'));
@@ -0,0 +1,126 @@
+// Checks the /api/stream push feed of server.js against replay-server.js:
+// a status whose scrape fails must not be pushed as removed.
+//
+//   npm install && node replay-server.js -- node stream-check.js
+//
+// server.js runs from a scratch directory holding a config.json that points
+// it at the replay server, as the user "flaky" (one status fails after its
+// first scrape), with a short push interval.
+
+const fs = require('fs');
+const http = require('http');
+const net = require('net');
+const os = require('os');
+const path = require('path');
+const { spawn } = require('child_process');
+
+const WATCH_MS = 3000; // several push intervals
+const PUSH_INTERVAL_S = 0.4;
+
+let failed = 0;
+function check(name, ok, detail) {
+  console.log(`${ok ? 'PASS' : 'FAIL'} ${name}${detail ? `: ${detail}` : ''}`);
+  if (!ok) failed++;
+}
+
+function freePort() {
+  return new Promise(resolve => {
+    const probe = net.createServer().listen(0, '127.0.0.1', () => {
+      const { port } = probe.address();
+      probe.close(() => resolve(port));
+    });
+  });
+}
+
+function getJson(url) {
+  return new Promise((resolve, reject) => {
+    http.get(url, res => {
+      let body = '';
+      res.on('data', chunk => { body += chunk; });
+      res.on('end', () => resolve(JSON.parse(body)));
+    }).on('error', reject);
+  });
+}
+
+// Events of an SSE stream for `ms`, retrying the connection while the
+// server starts
+function readEvents(url, ms) {
+  return new Promise((resolve, reject) => {
+    const deadline = Date.now() + 10000;
+    const connect = () => {
+      const req = http.get(url, res => {
+        const events = [];
+        let buffer = '';
+        res.on('data', chunk => {
+          buffer += chunk;
+          let end;
+          while ((end = buffer.indexOf('\n\n')) >= 0) {
+            const block = buffer.slice(0, end);
+            buffer = buffer.slice(end + 2);
+            const event = /^event: (.*)$/m.exec(block);
+            const data = /^data: (.*)$/m.exec(block);
+            if (event && data) events.push({ event: event[1], data: JSON.parse(data[1]) });
+          }
+        });
+        setTimeout(() => {
+          req.destroy();
+          resolve(events);
+        }, ms);
+      });
+      req.on('error', err => {
+        if (Date.now() > deadline) reject(err);
+        else setTimeout(connect, 200);
+      });
+    };
+    connect();
+  });
+}
+
+async function main() {
+  const base = process.argv[process.argv.length - 1];
+  try {
+    require.resolve('express', { paths: [__dirname] });
+  } catch (err) {
+    console.log('SKIP server.js dependencies are not installed (npm install)');
+    return 0;
+  }
+
+  const port = await freePort();
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'stream-check-'));
+  fs.writeFileSync(path.join(dir, 'config.json'), JSON.stringify({
+    malUsername: 'flaky',
+    port,
+    malBaseUrl: base,
+    pushInterval: PUSH_INTERVAL_S
+  }));
+  const server = spawn(process.execPath, [path.join(__dirname, 'server.js')], {
+    cwd: dir,
+    env: { ...process.env, NO_TRAY: '1' },
+    stdio: 'ignore'
+  });
+
+  try {
+    await getJson(`${base}/log`);
+    const events = await readEvents(`http://127.0.0.1:${port}/api/stream?media=anime&status=ALL`, WATCH_MS);
+    const log = await getJson(`${base}/log`);
+
+    const snapshot = events.find(e => e.event === 'snapshot');
+    check('the first scrape is pushed as a snapshot', snapshot && snapshot.data.items.length === 5,
+      snapshot ? `${snapshot.data.items.length} items` : 'no snapshot');
+
+    const failedScrapes = log.requests.filter(r => r === 'GET /animelist/flaky?status=2').length - 1;
+    check('later scrapes of the flaky status failed', failedScrapes >= 2, `${failedScrapes} failed`);
+
+    const removed = events.filter(e => e.event === 'diff').flatMap(e => e.data.removed);
+    check('a failed status is not pushed as removed', removed.length === 0, removed.join(', '));
+  } finally {
+    server.kill();
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+  return failed === 0 ? 0 : 1;
+}
+
+main().then(code => process.exit(code), err => {
+  console.error(err);
+  process.exit(1);
+});